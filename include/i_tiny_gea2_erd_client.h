@@ -6,8 +6,10 @@
 #ifndef i_tiny_gea2_erd_client_h
 #define i_tiny_gea2_erd_client_h
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "i_tiny_event.h"
+#include "i_tiny_time_source.h"
 #include "tiny_erd.h"
 
 enum {
@@ -19,16 +21,54 @@ enum {
 typedef uint8_t tiny_gea2_erd_client_activity_type_t;
 
 enum {
-  tiny_gea2_erd_client_read_failure_reason_retries_exhausted
+  tiny_gea2_erd_client_read_failure_reason_retries_exhausted,
+  tiny_gea2_erd_client_read_failure_reason_deadline_expired
 };
 typedef uint8_t tiny_gea2_erd_client_read_failure_reason_t;
 
 enum {
-  tiny_gea2_erd_client_write_failure_reason_retries_exhausted
+  tiny_gea2_erd_client_write_failure_reason_retries_exhausted,
+  tiny_gea2_erd_client_write_failure_reason_deadline_expired
 };
 typedef uint8_t tiny_gea2_erd_client_write_failure_reason_t;
 
-typedef uint8_t tiny_gea2_erd_client_request_id_t;
+/*!
+ * Request IDs are handles for queued requests and are independent of any ID sent on the wire.
+ * They can be made 16 or 32 bits wide so that they remain unique across deep queues.
+ */
+#ifndef TINY_GEA2_ERD_CLIENT_REQUEST_ID_BITS
+#define TINY_GEA2_ERD_CLIENT_REQUEST_ID_BITS 16
+#endif
+
+#if TINY_GEA2_ERD_CLIENT_REQUEST_ID_BITS == 16
+typedef uint16_t tiny_gea2_erd_client_request_id_t;
+#elif TINY_GEA2_ERD_CLIENT_REQUEST_ID_BITS == 32
+typedef uint32_t tiny_gea2_erd_client_request_id_t;
+#else
+#error "TINY_GEA2_ERD_CLIENT_REQUEST_ID_BITS must be 16 or 32"
+#endif
+
+typedef struct {
+  /*!
+   * Number of ticks after the request is queued after which it will be failed instead of sent
+   * or retried. 0 means that the request has no deadline.
+   */
+  tiny_time_source_ticks_t deadline;
+
+  /*!
+   * Requests with a higher priority are sent before requests with a lower priority. Requests
+   * for the same ERD are still sent in order if either is a write. Only the 8 oldest queued
+   * requests are considered for being sent early so a request does not skip ahead until it is
+   * among them. 0 is the default priority.
+   */
+  uint8_t priority;
+
+  /*!
+   * Writes only. The write completes as soon as the interface accepts the packet instead of
+   * waiting for a write response. It is still sent in order with other requests for the same ERD.
+   */
+  bool unacknowledged;
+} tiny_gea2_erd_client_request_options_t;
 
 typedef struct {
   tiny_gea2_erd_client_activity_type_t type;
@@ -91,6 +131,24 @@ typedef struct i_tiny_gea2_erd_client_api_t {
     uint8_t data_size);
 
   i_tiny_event_t* (*on_activity)(i_tiny_gea2_erd_client_t* self);
+
+  bool (*read_with_options)(
+    i_tiny_gea2_erd_client_t* self,
+    tiny_gea2_erd_client_request_id_t* request_id,
+    uint8_t address,
+    tiny_erd_t erd,
+    const tiny_gea2_erd_client_request_options_t* options);
+
+  bool (*write_with_options)(
+    i_tiny_gea2_erd_client_t* self,
+    tiny_gea2_erd_client_request_id_t* request_id,
+    uint8_t address,
+    tiny_erd_t erd,
+    const void* data,
+    uint8_t data_size,
+    const tiny_gea2_erd_client_request_options_t* options);
+
+  bool (*cancel)(i_tiny_gea2_erd_client_t* self, tiny_gea2_erd_client_request_id_t request_id);
 } i_tiny_gea2_erd_client_api_t;
 
 /*!
@@ -121,6 +179,51 @@ static inline bool tiny_gea2_erd_client_write(
   return self->api->write(self, request_id, address, erd, data, data_size);
 }
 
+/*!
+ * Send a read ERD request to ERD host with per-request options. Returns true if the request could
+ * be queued, false otherwise.
+ */
+static inline bool tiny_gea2_erd_client_read_with_options(
+  i_tiny_gea2_erd_client_t* self,
+  tiny_gea2_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const tiny_gea2_erd_client_request_options_t* options)
+{
+  return self->api->read_with_options(self, request_id, address, erd, options);
+}
+
+/*!
+ * Send a write ERD request to an ERD host with per-request options. Returns true if the request
+ * could be queued, false otherwise.
+ * @warning Data must already be in big endian. Implementers will not have enough information to
+ *    swap on the client's behalf.
+ */
+static inline bool tiny_gea2_erd_client_write_with_options(
+  i_tiny_gea2_erd_client_t* self,
+  tiny_gea2_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const void* data,
+  uint8_t data_size,
+  const tiny_gea2_erd_client_request_options_t* options)
+{
+  return self->api->write_with_options(self, request_id, address, erd, data, data_size, options);
+}
+
+/*!
+ * Cancel a queued request. No activity is published for a cancelled request. Returns true if the
+ * request was found.
+ *
+ * GEA2 responses carry no request ID so a request that is cancelled while it is in flight holds
+ * off the next request until its response arrives or it times out. This keeps a late response
+ * from completing the next request to the same address and ERD.
+ */
+static inline bool tiny_gea2_erd_client_cancel(i_tiny_gea2_erd_client_t* self, tiny_gea2_erd_client_request_id_t request_id)
+{
+  return self->api->cancel(self, request_id);
+}
+
 /*!
  * Event that is raised when a read or write request is completed.
  */
@@ -6,9 +6,12 @@
 #ifndef i_tiny_gea3_erd_client_h
 #define i_tiny_gea3_erd_client_h
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "i_tiny_event.h"
+#include "i_tiny_time_source.h"
 #include "tiny_erd.h"
+#include "tiny_gea_erd_view.h"
 
 enum {
   tiny_gea3_erd_client_activity_type_read_completed,
@@ -18,24 +21,92 @@ enum {
   tiny_gea3_erd_client_activity_type_subscription_added_or_retained,
   tiny_gea3_erd_client_activity_type_subscribe_failed,
   tiny_gea3_erd_client_activity_type_subscription_publication_received,
-  tiny_gea3_erd_client_activity_type_subscription_host_came_online
+  tiny_gea3_erd_client_activity_type_subscription_host_came_online,
+  tiny_gea3_erd_client_activity_type_subscription_publication_batch_received,
+  tiny_gea3_erd_client_activity_type_gather_read_completed,
+  tiny_gea3_erd_client_activity_type_batch_completed
 };
 typedef uint8_t tiny_gea3_erd_client_activity_type_t;
 
 enum {
   tiny_gea3_erd_client_read_failure_reason_retries_exhausted,
-  tiny_gea3_erd_client_read_failure_reason_not_supported
+  tiny_gea3_erd_client_read_failure_reason_not_supported,
+  tiny_gea3_erd_client_read_failure_reason_deadline_expired
 };
 typedef uint8_t tiny_gea3_erd_client_read_failure_reason_t;
 
 enum {
   tiny_gea3_erd_client_write_failure_reason_retries_exhausted,
   tiny_gea3_erd_client_write_failure_reason_not_supported,
-  tiny_gea3_erd_client_write_failure_reason_incorrect_size
+  tiny_gea3_erd_client_write_failure_reason_incorrect_size,
+  tiny_gea3_erd_client_write_failure_reason_deadline_expired
 };
 typedef uint8_t tiny_gea3_erd_client_write_failure_reason_t;
 
-typedef uint8_t tiny_gea3_erd_client_request_id_t;
+/*!
+ * Request IDs are handles for queued requests and are independent of any ID sent on the wire.
+ * They can be made 16 or 32 bits wide so that they remain unique across deep queues.
+ */
+#ifndef TINY_GEA3_ERD_CLIENT_REQUEST_ID_BITS
+#define TINY_GEA3_ERD_CLIENT_REQUEST_ID_BITS 16
+#endif
+
+#if TINY_GEA3_ERD_CLIENT_REQUEST_ID_BITS == 16
+typedef uint16_t tiny_gea3_erd_client_request_id_t;
+#elif TINY_GEA3_ERD_CLIENT_REQUEST_ID_BITS == 32
+typedef uint32_t tiny_gea3_erd_client_request_id_t;
+#else
+#error "TINY_GEA3_ERD_CLIENT_REQUEST_ID_BITS must be 16 or 32"
+#endif
+
+typedef struct {
+  /*!
+   * Number of ticks after the request is queued after which it will be failed instead of sent
+   * or retried. 0 means that the request has no deadline.
+   */
+  tiny_time_source_ticks_t deadline;
+
+  /*!
+   * Requests with a higher priority are sent before requests with a lower priority. Requests
+   * for the same ERD are still sent in order if either is a write. Only the 8 oldest queued
+   * requests are considered for being sent early so a request does not skip ahead until it is
+   * among them. 0 is the default priority.
+   */
+  uint8_t priority;
+
+  /*!
+   * Writes only. The write completes as soon as the interface accepts the packet instead of
+   * waiting for a write response. It is still sent in order with other requests for the same ERD.
+   */
+  bool unacknowledged;
+} tiny_gea3_erd_client_request_options_t;
+
+enum {
+  tiny_gea3_erd_client_batch_item_status_pending,
+  tiny_gea3_erd_client_batch_item_status_completed,
+  tiny_gea3_erd_client_batch_item_status_retries_exhausted,
+  tiny_gea3_erd_client_batch_item_status_not_supported,
+  tiny_gea3_erd_client_batch_item_status_incorrect_size
+};
+typedef uint8_t tiny_gea3_erd_client_batch_item_status_t;
+
+/*!
+ * One ERD in a batch read or write. Items are owned by the caller and are updated in place
+ * so they must remain valid until the batch completes or is cancelled.
+ *
+ * For writes, data and data_size describe the data to write. For reads, data and data_size
+ * describe the buffer that the result is copied into and data_size is updated to the size
+ * that was read. A read result that does not fit is reported as incorrect_size.
+ *
+ * @warning Data is in big endian.
+ */
+typedef struct {
+  void* data;
+  tiny_erd_t erd;
+  uint8_t address;
+  uint8_t data_size;
+  tiny_gea3_erd_client_batch_item_status_t status;
+} tiny_gea3_erd_client_batch_item_t;
 
 typedef struct {
   tiny_gea3_erd_client_activity_type_t type;
@@ -83,9 +154,46 @@ typedef struct {
       const void* data;
       uint8_t data_size;
     } subscription_publication_received;
+
+    /*!
+     * Raised once per publication after the individual subscription_publication_received
+     * events. Entries point directly into the received packet and are only valid for the
+     * duration of the event. Use a tiny_gea3_erd_client_publication_iterator_t to visit them.
+     * @warning Data will be in big endian. Implementations will not have enough information to
+     * swap on the client's behalf.
+     */
+    struct {
+      const void* entries;
+      uint8_t entries_size;
+      uint8_t erd_count;
+    } subscription_publication_batch_received;
+
+    /*!
+     * Raised when the collection window of a gather read closes. Each response was
+     * already reported as a read_completed with the same request ID.
+     */
+    struct {
+      tiny_gea3_erd_client_request_id_t request_id;
+      tiny_erd_t erd;
+      uint16_t responder_count;
+    } gather_read_completed;
+
+    /*!
+     * Raised once all items in a batch have completed or failed. The status of each item
+     * is in the item itself.
+     */
+    struct {
+      tiny_gea3_erd_client_request_id_t request_id;
+      const tiny_gea3_erd_client_batch_item_t* items;
+      uint8_t item_count;
+      uint8_t failed_count;
+    } batch_completed;
   };
 } tiny_gea3_erd_client_on_activity_args_t;
 
+typedef tiny_gea_erd_view_entry_t tiny_gea3_erd_client_publication_entry_t;
+typedef tiny_gea_erd_view_t tiny_gea3_erd_client_publication_iterator_t;
+
 struct i_tiny_gea3_erd_client_api_t;
 
 typedef struct {
@@ -112,6 +220,32 @@ typedef struct i_tiny_gea3_erd_client_api_t {
   bool (*retain_subscription)(i_tiny_gea3_erd_client_t* self, uint8_t address);
 
   i_tiny_event_t* (*on_activity)(i_tiny_gea3_erd_client_t* self);
+  bool (*read_with_options)(
+    i_tiny_gea3_erd_client_t* self,
+    tiny_gea3_erd_client_request_id_t* request_id,
+    uint8_t address,
+    tiny_erd_t erd,
+    const tiny_gea3_erd_client_request_options_t* options);
+  bool (*write_with_options)(
+    i_tiny_gea3_erd_client_t* self,
+    tiny_gea3_erd_client_request_id_t* request_id,
+    uint8_t address,
+    tiny_erd_t erd,
+    const void* data,
+    uint8_t data_size,
+    const tiny_gea3_erd_client_request_options_t* options);
+  bool (*cancel)(i_tiny_gea3_erd_client_t* self, tiny_gea3_erd_client_request_id_t request_id);
+  bool (*gather_read)(i_tiny_gea3_erd_client_t* self, tiny_gea3_erd_client_request_id_t* request_id, tiny_erd_t erd);
+  bool (*read_batch)(
+    i_tiny_gea3_erd_client_t* self,
+    tiny_gea3_erd_client_request_id_t* request_id,
+    tiny_gea3_erd_client_batch_item_t* items,
+    uint8_t item_count);
+  bool (*write_batch)(
+    i_tiny_gea3_erd_client_t* self,
+    tiny_gea3_erd_client_request_id_t* request_id,
+    tiny_gea3_erd_client_batch_item_t* items,
+    uint8_t item_count);
 } i_tiny_gea3_erd_client_api_t;
 
 /*!
@@ -142,6 +276,92 @@ static inline bool tiny_gea3_erd_client_write(
   return self->api->write(self, request_id, address, erd, data, data_size);
 }
 
+/*!
+ * Send a read ERD request to ERD host with per-request options. Returns true if the request could
+ * be queued, false otherwise.
+ */
+static inline bool tiny_gea3_erd_client_read_with_options(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const tiny_gea3_erd_client_request_options_t* options)
+{
+  return self->api->read_with_options(self, request_id, address, erd, options);
+}
+
+/*!
+ * Send a write ERD request to an ERD host with per-request options. Returns true if the request
+ * could be queued, false otherwise.
+ * @warning Data must already be in big endian. Implementers will not have enough information to
+ *    swap on the client's behalf.
+ */
+static inline bool tiny_gea3_erd_client_write_with_options(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const void* data,
+  uint8_t data_size,
+  const tiny_gea3_erd_client_request_options_t* options)
+{
+  return self->api->write_with_options(self, request_id, address, erd, data, data_size, options);
+}
+
+/*!
+ * Cancel a queued request. If the request is in flight then any response to it will be ignored.
+ * No activity is published for a cancelled request. Returns true if the request was found.
+ */
+static inline bool tiny_gea3_erd_client_cancel(i_tiny_gea3_erd_client_t* self, tiny_gea3_erd_client_request_id_t request_id)
+{
+  return self->api->cancel(self, request_id);
+}
+
+/*!
+ * Send a read ERD request to all ERD hosts and collect responses until the configured gather
+ * window closes. Each response is reported as a read_completed and a gather_read_completed is
+ * raised when the window closes. Returns true if the request could be queued, false otherwise.
+ */
+static inline bool tiny_gea3_erd_client_gather_read(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  tiny_erd_t erd)
+{
+  return self->api->gather_read(self, request_id, erd);
+}
+
+/*!
+ * Read a set of ERDs as a single queued request. Each ERD is still read with its own read
+ * request, one after the other, and the results are copied into the items as they arrive. A
+ * single batch_completed is raised when every item has completed or failed. Returns true if
+ * the batch could be queued, false otherwise. Items that are already queued or in flight are
+ * rejected and left as they are.
+ */
+static inline bool tiny_gea3_erd_client_read_batch(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  tiny_gea3_erd_client_batch_item_t* items,
+  uint8_t item_count)
+{
+  return self->api->read_batch(self, request_id, items, item_count);
+}
+
+/*!
+ * Write a set of ERDs as a single queued request. Each ERD is still written with its own write
+ * request, one after the other. A single batch_completed is raised when every item has
+ * completed or failed. Returns true if the batch could be queued, false otherwise. Items that
+ * are already queued or in flight are rejected and left as they are.
+ * @warning Data must already be in big endian.
+ */
+static inline bool tiny_gea3_erd_client_write_batch(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  tiny_gea3_erd_client_batch_item_t* items,
+  uint8_t item_count)
+{
+  return self->api->write_batch(self, request_id, items, item_count);
+}
+
 /*!
  * Send a subscribe request to an ERD host. Returns true if the request could be queued, false otherwise.
  */
@@ -158,6 +378,31 @@ static inline bool tiny_gea3_erd_client_retain_subscription(i_tiny_gea3_erd_clie
   return self->api->retain_subscription(self, address);
 }
 
+/*!
+ * Initialize an iterator over the ERDs in a subscription_publication_batch_received event.
+ */
+static inline void tiny_gea3_erd_client_publication_iterator_init(
+  tiny_gea3_erd_client_publication_iterator_t* self,
+  const tiny_gea3_erd_client_on_activity_args_t* args)
+{
+  tiny_gea_erd_view_init(
+    self,
+    args->subscription_publication_batch_received.entries,
+    args->subscription_publication_batch_received.entries_size,
+    args->subscription_publication_batch_received.erd_count);
+}
+
+/*!
+ * Get the next ERD in the publication without copying its data. Returns false when all ERDs
+ * have been visited.
+ */
+static inline bool tiny_gea3_erd_client_publication_iterator_next(
+  tiny_gea3_erd_client_publication_iterator_t* self,
+  tiny_gea3_erd_client_publication_entry_t* entry)
+{
+  return tiny_gea_erd_view_next(self, entry);
+}
+
 /*!
  * Event that is raised when a read, write, subscribe request completes and when a subscription host comes online.
  */
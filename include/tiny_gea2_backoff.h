@@ -0,0 +1,47 @@
+/*!
+ * @file
+ * @brief Cooldown policy for tiny_gea2_interface with randomized, exponential collision backoff
+ * and shortened cooldowns for priority packets.
+ *
+ * The random part of the collision cooldown comes from a xorshift PRNG instead of the time
+ * source so nodes with similar addresses and timing do not keep choosing the same slot. Each
+ * failed attempt doubles the number of random slots up to a limit. Priority packets skip the
+ * address-dependent part of both cooldowns and use the idle cooldown base after a collision.
+ * Only fairness_limit cooldowns in a row are shortened so a node sending a steady stream of
+ * priority packets cannot starve other nodes.
+ */
+
+#ifndef tiny_gea2_backoff_h
+#define tiny_gea2_backoff_h
+
+#include <stdint.h>
+#include "tiny_gea2_interface.h"
+
+typedef struct {
+  uint32_t random_state;
+  uint8_t max_exponent;
+  uint8_t fairness_limit;
+  uint8_t shortened_in_a_row;
+} tiny_gea2_backoff_t;
+
+/*!
+ * Initialize a backoff policy. The seed should differ between nodes, ie: derived from a serial
+ * number. The number of random collision slots is 32 << min(attempt - 1, max_exponent). The
+ * max_exponent is limited to 10, larger values are clamped. Cooldowns that do not fit in
+ * tiny_timer_ticks_t saturate.
+ */
+void tiny_gea2_backoff_init(
+  tiny_gea2_backoff_t* self,
+  uint32_t seed,
+  uint8_t max_exponent,
+  uint8_t fairness_limit);
+
+/*!
+ * Cooldown policy to give to tiny_gea2_interface_set_cooldown_policy() with the backoff as the
+ * context.
+ */
+tiny_timer_ticks_t tiny_gea2_backoff_cooldown(
+  void* context,
+  const tiny_gea2_interface_cooldown_args_t* args);
+
+#endif
@@ -0,0 +1,53 @@
+/*!
+ * @file
+ * @brief Records the most recent GEA2 diagnostics events in a ring buffer so that they can be
+ * dumped later. When the buffer is full the oldest event is overwritten.
+ *
+ * Events are recorded in the interrupt context. Entries should be read while the bus is quiet or
+ * with the interrupt masked to avoid reading an entry that is being overwritten.
+ */
+
+#ifndef tiny_gea2_diagnostics_recorder_h
+#define tiny_gea2_diagnostics_recorder_h
+
+#include <stdint.h>
+#include "tiny_event.h"
+#include "tiny_gea2_interface.h"
+
+typedef struct {
+  tiny_event_subscription_t diagnostics_event;
+  tiny_gea2_interface_diagnostics_event_args_t* entries;
+  uint16_t entry_count;
+  uint16_t next;
+  uint16_t count;
+} tiny_gea2_diagnostics_recorder_t;
+
+/*!
+ * Initialize a recorder with storage for entry_count events and start recording events raised by
+ * a GEA2 interface. entry_count must be at least 1, a recorder without storage records nothing.
+ */
+void tiny_gea2_diagnostics_recorder_init(
+  tiny_gea2_diagnostics_recorder_t* self,
+  tiny_gea2_interface_t* gea2_interface,
+  tiny_gea2_interface_diagnostics_event_args_t* entries,
+  uint16_t entry_count);
+
+/*!
+ * Number of recorded events.
+ */
+uint16_t tiny_gea2_diagnostics_recorder_count(tiny_gea2_diagnostics_recorder_t* self);
+
+/*!
+ * Get a recorded event. Index 0 is the oldest recorded event. Returns NULL if there is no event at
+ * the index.
+ */
+const tiny_gea2_interface_diagnostics_event_args_t* tiny_gea2_diagnostics_recorder_entry(
+  tiny_gea2_diagnostics_recorder_t* self,
+  uint16_t index);
+
+/*!
+ * Discard all recorded events.
+ */
+void tiny_gea2_diagnostics_recorder_clear(tiny_gea2_diagnostics_recorder_t* self);
+
+#endif
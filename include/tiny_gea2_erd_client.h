@@ -16,6 +16,15 @@ typedef struct
 {
   tiny_timer_ticks_t request_timeout;
   uint8_t request_retries;
+
+  // Number of consecutive requests that can be sent ahead of the oldest queued request because
+  // of their priority before the oldest request is sent. 0 gives strict priority.
+  uint8_t priority_burst_limit;
+
+  // Maximum number of consecutive requests that can be sent to one address ahead of older
+  // requests to other addresses. This groups requests by destination without reordering
+  // requests for the same ERD. 0 disables grouping.
+  uint8_t address_run_limit;
 } tiny_gea2_erd_client_configuration_t;
 
 typedef struct
@@ -30,8 +39,16 @@ typedef struct
   tiny_event_t on_activity;
   const tiny_gea2_erd_client_configuration_t* configuration;
   uint8_t remaining_retries;
-  tiny_gea2_erd_client_request_id_t request_id;
+  tiny_gea2_erd_client_request_id_t next_request_id;
+  uint16_t active_index;
+  uint8_t priority_burst_count;
+  uint8_t last_address;
+  uint8_t address_run_count;
+  uint8_t cancelled_address;
+  tiny_erd_t cancelled_erd;
   bool busy;
+  bool sending_requests;
+  bool waiting_out_cancelled_request;
 } tiny_gea2_erd_client_t;
 
 /*!
@@ -12,11 +12,16 @@
  *
  * Note: This module requires an interrupt event. This "interrupt" is an event
  * that needs to happen in the same context as the `on_receive`.
+ *
+ * Alternatively, the interface can run tickless. In that case no interrupt event
+ * is given and a one-shot timer is armed for the next deadline instead. See
+ * tiny_gea2_interface_service().
  */
 
 #ifndef tiny_gea2_interface_h
 #define tiny_gea2_interface_h
 
+#include <stdint.h>
 #include "hal/i_tiny_uart.h"
 #include "i_tiny_gea_interface.h"
 #include "i_tiny_time_source.h"
@@ -26,6 +31,72 @@
 #include "tiny_queue.h"
 #include "tiny_timer.h"
 
+#define tiny_gea2_interface_no_deadline ((tiny_timer_ticks_t)UINT32_MAX)
+
+enum {
+  tiny_gea2_interface_max_send_window = 8
+};
+
+/*!
+ * Bus timing in time source ticks. The idle cooldown is idle_cooldown_base plus
+ * (address & 0x1F) steps. The collision cooldown is collision_cooldown_base plus
+ * (address & 0x1F) steps plus a pseudo-random 0 to 31 steps.
+ */
+typedef struct
+{
+  tiny_timer_ticks_t reflection_timeout;
+  tiny_timer_ticks_t ack_timeout;
+  tiny_timer_ticks_t interbyte_timeout;
+  tiny_timer_ticks_t idle_cooldown_base;
+  tiny_timer_ticks_t collision_cooldown_base;
+  tiny_timer_ticks_t cooldown_step;
+} tiny_gea2_interface_timing_t;
+
+enum {
+  tiny_gea2_interface_cooldown_idle,
+  tiny_gea2_interface_cooldown_collision
+};
+typedef uint8_t tiny_gea2_interface_cooldown_t;
+
+typedef struct
+{
+  const tiny_gea2_interface_timing_t* timing;
+  tiny_gea2_interface_cooldown_t cooldown;
+  uint8_t address;
+  uint8_t attempt; // Number of failed attempts to send the current packet
+  bool priority; // The current packet is from the priority send queue
+} tiny_gea2_interface_cooldown_args_t;
+
+typedef tiny_timer_ticks_t (*tiny_gea2_interface_cooldown_policy_t)(
+  void* context,
+  const tiny_gea2_interface_cooldown_args_t* args);
+
+/*!
+ * Returns the number of ticks until this node may start sending or 0 if it may start now.
+ */
+typedef tiny_timer_ticks_t (*tiny_gea2_interface_transmit_gate_t)(void* context);
+
+enum {
+  tiny_gea2_interface_diagnostics_event_packet_received,
+  tiny_gea2_interface_diagnostics_event_packet_dropped,
+  tiny_gea2_interface_diagnostics_event_interbyte_timeout,
+  tiny_gea2_interface_diagnostics_event_packet_sent,
+  tiny_gea2_interface_diagnostics_event_collision,
+  tiny_gea2_interface_diagnostics_event_reflection_timeout,
+  tiny_gea2_interface_diagnostics_event_ack_timeout,
+  tiny_gea2_interface_diagnostics_event_retries_exhausted
+};
+typedef uint8_t tiny_gea2_interface_diagnostics_event_type_t;
+
+typedef struct
+{
+  tiny_time_source_ticks_t timestamp;
+  tiny_gea2_interface_diagnostics_event_type_t type;
+  uint8_t address; // Source for received packets, destination for sent packets, broadcast if unknown
+  uint8_t attempt; // Number of failed attempts to send the packet before this event
+  bool broadcast; // The packet was addressed to the broadcast address
+} tiny_gea2_interface_diagnostics_event_args_t;
+
 typedef struct
 {
   i_tiny_gea_interface_t interface;
@@ -37,14 +108,25 @@ typedef struct
   tiny_event_subscription_t byte_received_subscription;
   i_tiny_uart_t* uart;
   tiny_timer_t timer;
+  tiny_time_source_ticks_t last_byte_time;
   uint8_t address;
   bool ignore_destination_address;
+  const uint8_t* address_filter;
+  bool diagnostics_enabled;
+  const tiny_gea2_interface_timing_t* timing;
+  tiny_gea2_interface_cooldown_policy_t cooldown_policy;
+  void* cooldown_policy_context;
+  tiny_gea2_interface_transmit_gate_t transmit_gate;
+  void* transmit_gate_context;
   uint8_t retries;
   tiny_timer_group_t timer_group;
 
   struct
   {
     tiny_queue_t queue;
+    tiny_queue_t priority_queue;
+    tiny_queue_t* active_queue;
+    const uint8_t* priority_commands;
     uint8_t state;
     uint8_t offset;
     uint16_t crc;
@@ -52,7 +134,22 @@ typedef struct
     volatile bool in_progress; // Set and cleared by the non-ISR, read by the ISR
     volatile bool completed; // Set by ISR, cleared by non-ISR
     volatile bool packet_queued_in_background; // Set by ISR, cleared by non-ISR
-    uint8_t expected_reflection;
+    uint8_t expected_reflections[tiny_gea2_interface_max_send_window];
+    uint8_t reflection_head;
+    uint8_t reflections_in_flight;
+    uint8_t window;
+    uint16_t index;
+    bool rotate_destinations;
+    volatile bool can_rotate; // Set by the non-ISR, read by the ISR
+    volatile bool deferred; // Set by ISR, cleared by non-ISR
+
+    struct
+    {
+      bool active;
+      bool other_destination_sent;
+      uint8_t destination;
+      uint8_t retries;
+    } backoff;
     uint8_t retries;
     uint8_t data_length;
   } send;
@@ -64,12 +161,13 @@ typedef struct
     uint8_t buffer_size;
     uint8_t count;
     bool escaped;
+    bool dropping;
     volatile bool packet_ready;
   } receive;
 } tiny_gea2_interface_t;
 
 /*!
- * Initialize a GEA2 interface.
+ * Initialize a GEA2 interface. If msec_interrupt is NULL then the interface runs tickless.
  */
 void tiny_gea2_interface_init(
   tiny_gea2_interface_t* self,
@@ -84,6 +182,141 @@ void tiny_gea2_interface_init(
   bool ignore_destination_address,
   uint8_t retries);
 
+/*!
+ * Derive bus timing for a baud rate and a time source that ticks ticks_per_second times per
+ * second. The timeouts take the same number of bit times as the default timing at 19200 baud
+ * with a 1 msec tick. Every timeout is at least one tick.
+ */
+void tiny_gea2_interface_timing_init(
+  tiny_gea2_interface_timing_t* timing,
+  uint32_t baud,
+  uint32_t ticks_per_second);
+
+/*!
+ * Use custom bus timing. The timing is not copied. By default the interface uses timing for
+ * 19200 baud with a 1 msec tick.
+ */
+void tiny_gea2_interface_set_timing(
+  tiny_gea2_interface_t* self,
+  const tiny_gea2_interface_timing_t* timing);
+
+/*!
+ * The cooldown policy used when no custom policy is set. The cooldowns are derived from the timing
+ * and the address with the low byte of the time source as the random part of the collision
+ * cooldown. The context is the interface's time source (i_tiny_time_source_t*). Policies that
+ * only change some cooldowns can delegate to this.
+ */
+tiny_timer_ticks_t tiny_gea2_interface_default_cooldown_policy(
+  void* context,
+  const tiny_gea2_interface_cooldown_args_t* args);
+
+/*!
+ * Use a custom policy to choose idle and collision cooldown durations. By default
+ * tiny_gea2_interface_default_cooldown_policy is used. See tiny_gea2_backoff for a policy with a
+ * real PRNG, exponential backoff and shortened cooldowns for priority packets.
+ */
+void tiny_gea2_interface_set_cooldown_policy(
+  tiny_gea2_interface_t* self,
+  void* context,
+  tiny_gea2_interface_cooldown_policy_t policy);
+
+/*!
+ * Use a gate to decide when this node may start sending once the bus is idle. The gate is called
+ * from the same context as the UART's on_receive whenever a packet is ready to be sent and the bus
+ * is idle. If it returns a non-zero number of ticks then the gate is checked again after that
+ * many ticks or after the next bus activity. See tiny_gea2_tdma for a time-slotted gate.
+ */
+void tiny_gea2_interface_set_transmit_gate(
+  tiny_gea2_interface_t* self,
+  void* context,
+  tiny_gea2_interface_transmit_gate_t gate);
+
+/*!
+ * Keep up to window bytes in flight while sending instead of waiting for the reflection of each
+ * byte before sending the next. Reflections are still checked in order and a mismatch aborts the
+ * packet as a collision. Only useful with a UART that buffers sent bytes. Defaults to 1, the
+ * window is limited to tiny_gea2_interface_max_send_window.
+ */
+void tiny_gea2_interface_set_send_window(
+  tiny_gea2_interface_t* self,
+  uint8_t window);
+
+/*!
+ * After a failed attempt to send a packet, send a queued packet for another destination before
+ * retrying instead of blocking the queue until the retries are exhausted. The packet being retried
+ * keeps its remaining retries and packets for the same destination are always sent in order. Only
+ * one destination is backed off at a time. Disabled by default.
+ */
+void tiny_gea2_interface_rotate_destinations_after_failures(
+  tiny_gea2_interface_t* self,
+  bool enabled);
+
+/*!
+ * Accept and acknowledge packets for every address whose bit is set in a 256-bit (32 byte) bitmap
+ * in addition to the interface's own address and the broadcast address. Bit (address % 8) of byte
+ * (address / 8) corresponds to an address. The bitmap is not copied. Packets for other addresses
+ * are dropped as soon as their destination is received. Pass NULL to remove the filter.
+ */
+void tiny_gea2_interface_set_address_filter(
+  tiny_gea2_interface_t* self,
+  const uint8_t* address_filter);
+
+/*!
+ * Send packets whose command (first payload byte) has its bit set in a 256-bit (32 byte) bitmap
+ * through a separate queue that is served before the send queue. Bit (command % 8) of byte
+ * (command / 8) corresponds to a command. The bitmap is not copied. Priority packets are sent
+ * as soon as the packet being sent completes, including its retries.
+ */
+void tiny_gea2_interface_use_priority_send_queue(
+  tiny_gea2_interface_t* self,
+  uint8_t* priority_send_queue_buffer,
+  size_t priority_send_queue_buffer_size,
+  const uint8_t* priority_commands);
+
+/*!
+ * Stop receiving bytes through the UART's on_receive event. The UART driver must instead call
+ * tiny_gea2_interface_byte_received() for each received byte, which avoids publishing an event
+ * per byte. Other subscribers to the UART's on_receive event will no longer see received bytes
+ * unless the driver continues to publish them.
+ */
+void tiny_gea2_interface_use_direct_byte_receive(tiny_gea2_interface_t* self);
+
+/*!
+ * Handle a received byte. Must be called from the same context as the UART's on_receive. Data
+ * bytes received in the middle of a packet are buffered directly; only frame and escape bytes
+ * and bytes received outside of a packet go through the full state machine.
+ */
+void tiny_gea2_interface_byte_received(tiny_gea2_interface_t* self, uint8_t byte);
+
+/*!
+ * Service a tickless interface. Must be called from the same context as the UART's on_receive
+ * when a one-shot timer armed for the last returned deadline expires. Returns the number of ticks
+ * until the interface needs to be serviced again or tiny_gea2_interface_no_deadline if it is
+ * idle.
+ */
+tiny_timer_ticks_t tiny_gea2_interface_service(tiny_gea2_interface_t* self);
+
+/*!
+ * The number of ticks until a tickless interface needs to be serviced, 0 if it needs to be
+ * serviced immediately or tiny_gea2_interface_no_deadline if it is idle. The deadline can change
+ * after a byte is received and after tiny_gea2_interface_run() or a send so a one-shot timer
+ * should be re-armed then.
+ */
+tiny_timer_ticks_t tiny_gea2_interface_ticks_until_next_deadline(tiny_gea2_interface_t* self);
+
+/*!
+ * Start raising diagnostics events. They are off by default so the interface does no diagnostics
+ * work for applications that do not use them.
+ */
+void tiny_gea2_interface_enable_diagnostics(tiny_gea2_interface_t* self);
+
+/*!
+ * Event raised with tiny_gea2_interface_diagnostics_event_args_t for bus activity and errors once
+ * diagnostics have been enabled. The event is raised from the same context as the UART's
+ * on_receive so subscribers must be interrupt-safe.
+ */
+i_tiny_event_t* tiny_gea2_interface_on_diagnostics_event(tiny_gea2_interface_t* self);
+
 /*!
  * Run the interface and publish received packets.
  */
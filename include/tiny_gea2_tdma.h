@@ -0,0 +1,70 @@
+/*!
+ * @file
+ * @brief Time-slotted (TDMA) scheduling for tiny_gea2_interface on buses where every node uses it.
+ *
+ * Time is divided into frames of slot_count slots of slot_ticks ticks. Each slot is owned by the
+ * node whose address is in the slot table and a node only starts sending during its own slots so
+ * nodes do not collide and the worst case latency is bounded by the frame length.
+ *
+ * Frames are anchored to the end of each broadcast from the sync node: the slot after the sync
+ * node's slot starts when the broadcast ends so the sync node always yields the bus to the other
+ * nodes after sending. Nodes synchronize on the diagnostics events raised when the broadcast is
+ * received; the sync node synchronizes on the one raised when it has sent the broadcast. Sync is
+ * lost sync_timeout ticks after the last sync broadcast so the sync node should send one at least
+ * that often, ie: a periodic heartbeat.
+ *
+ * Until a node is synchronized, when sync is lost, for nodes that do not own a slot and for a
+ * config without slots or with zero length slots, normal arbitration is used: sending is not gated
+ * and cooldowns are given by the fallback policy or by tiny_gea2_interface_default_cooldown_policy
+ * if there is none.
+ */
+
+#ifndef tiny_gea2_tdma_h
+#define tiny_gea2_tdma_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "i_tiny_time_source.h"
+#include "tiny_event.h"
+#include "tiny_gea2_interface.h"
+
+typedef struct {
+  const uint8_t* slot_owners; // Address of the node that owns each slot
+  uint8_t slot_count;
+  tiny_timer_ticks_t slot_ticks;
+  tiny_timer_ticks_t guard_ticks; // A node only starts sending while this many ticks remain in its slot
+  uint8_t sync_address;
+  tiny_timer_ticks_t sync_timeout; // Plus the frame length, must be less than the period of the time source
+} tiny_gea2_tdma_config_t;
+
+typedef struct {
+  tiny_event_subscription_t diagnostics_event;
+  i_tiny_time_source_t* time_source;
+  const tiny_gea2_tdma_config_t* config;
+  void* fallback_context;
+  tiny_gea2_interface_cooldown_policy_t fallback;
+  tiny_time_source_ticks_t sync_time;
+  tiny_time_source_ticks_t frame_start;
+  uint8_t address;
+  bool synchronized;
+  bool config_valid;
+} tiny_gea2_tdma_t;
+
+/*!
+ * Initialize TDMA scheduling and install it as the transmit gate and cooldown policy of a GEA2
+ * interface. The fallback policy is used for cooldowns when not synchronized and can be NULL.
+ */
+void tiny_gea2_tdma_init(
+  tiny_gea2_tdma_t* self,
+  tiny_gea2_interface_t* gea2_interface,
+  i_tiny_time_source_t* time_source,
+  const tiny_gea2_tdma_config_t* config,
+  void* fallback_context,
+  tiny_gea2_interface_cooldown_policy_t fallback);
+
+/*!
+ * Returns true if the node is synchronized to the sync node's frames.
+ */
+bool tiny_gea2_tdma_synchronized(tiny_gea2_tdma_t* self);
+
+#endif
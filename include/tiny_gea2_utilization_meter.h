@@ -0,0 +1,80 @@
+/*!
+ * @file
+ * @brief Measures GEA2 bus utilization and contention over fixed windows.
+ *
+ * Every byte on the bus is seen by the UART (including reflections of bytes sent by this node)
+ * so bus activity is measured by counting received bytes and packet starts. Bytes sent by this
+ * node are counted with the UART's send complete event and send attempts are counted with the
+ * interface's diagnostics events.
+ *
+ * Counting is done in the interrupt context. Measurements are completed in the non-interrupt
+ * context by tiny_gea2_utilization_meter_run() so the counters are double buffered and the
+ * interrupt context only ever counts into the buffer for the current window.
+ */
+
+#ifndef tiny_gea2_utilization_meter_h
+#define tiny_gea2_utilization_meter_h
+
+#include <stdint.h>
+#include "hal/i_tiny_uart.h"
+#include "i_tiny_time_source.h"
+#include "tiny_event.h"
+#include "tiny_gea2_interface.h"
+
+typedef struct {
+  uint16_t busy_permille; // Fraction of the window that bytes were on the bus
+  uint16_t transmit_share_permille; // Fraction of the bytes on the bus that were sent by this node
+  uint32_t bytes_per_second;
+  uint16_t packets_per_second;
+  uint16_t retries_per_packet_x100; // Mean failed attempts per packet sent by this node, saturates at UINT16_MAX
+  uint16_t collision_permille; // Fraction of send attempts that ended in a collision
+} tiny_gea2_utilization_t;
+
+typedef struct {
+  uint32_t bytes;
+  uint32_t sent_bytes;
+  uint16_t packets;
+  uint16_t packets_sent;
+  uint16_t failed_attempts;
+  uint16_t collisions;
+} tiny_gea2_utilization_meter_counters_t;
+
+typedef struct {
+  tiny_event_subscription_t byte_received;
+  tiny_event_subscription_t byte_sent;
+  tiny_event_subscription_t diagnostics_event;
+  i_tiny_time_source_t* time_source;
+  tiny_gea2_utilization_meter_counters_t counters[2];
+  tiny_gea2_utilization_t utilization;
+  uint32_t baud;
+  uint32_t ticks_per_second;
+  tiny_time_source_ticks_t window_ticks;
+  tiny_time_source_ticks_t window_start;
+  volatile uint8_t current; // Set by the non-ISR, read by the ISR
+} tiny_gea2_utilization_meter_t;
+
+/*!
+ * Initialize a meter for a GEA2 interface and the UART that it uses. Measurements are made over
+ * windows of window_ticks ticks of a time source that ticks ticks_per_second times per second.
+ */
+void tiny_gea2_utilization_meter_init(
+  tiny_gea2_utilization_meter_t* self,
+  tiny_gea2_interface_t* gea2_interface,
+  i_tiny_uart_t* uart,
+  i_tiny_time_source_t* time_source,
+  uint32_t baud,
+  uint32_t ticks_per_second,
+  tiny_time_source_ticks_t window_ticks);
+
+/*!
+ * Complete the measurement for the current window if it has ended. Must be called periodically
+ * from the non-interrupt context.
+ */
+void tiny_gea2_utilization_meter_run(tiny_gea2_utilization_meter_t* self);
+
+/*!
+ * The measurement for the last completed window. All fields are 0 until a window has completed.
+ */
+const tiny_gea2_utilization_t* tiny_gea2_utilization_meter_utilization(tiny_gea2_utilization_meter_t* self);
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "i_tiny_gea3_erd_client.h"
 #include "i_tiny_gea_interface.h"
+#include "tiny_gea3_erd_api.h"
 #include "tiny_event.h"
 #include "tiny_queue.h"
 #include "tiny_ring_buffer.h"
@@ -16,6 +17,24 @@
 typedef struct {
   tiny_timer_ticks_t request_timeout;
   uint8_t request_retries;
+
+  // Number of consecutive requests that can be sent ahead of the oldest queued request because
+  // of their priority before the oldest request is sent. 0 gives strict priority.
+  uint8_t priority_burst_limit;
+
+  // Maximum number of consecutive requests that can be sent to one address ahead of older
+  // requests to other addresses. This groups requests by destination without reordering
+  // requests for the same ERD. 0 disables grouping.
+  uint8_t address_run_limit;
+
+  // Time that a gather read waits for responses before it completes.
+  tiny_timer_ticks_t gather_window;
+
+  // Range of request IDs sent on the wire. Clients that share an interface through a
+  // tiny_gea3_erd_client_router_t get their range from tiny_gea3_erd_client_router_configure_port().
+  // A count of 0 uses all 256 IDs.
+  tiny_gea3_erd_api_request_id_t first_request_id;
+  uint8_t request_id_count;
 } tiny_gea3_erd_client_configuration_t;
 
 typedef struct {
@@ -28,9 +47,17 @@ typedef struct {
   tiny_timer_t request_retry_timer;
   tiny_event_t on_activity;
   const tiny_gea3_erd_client_configuration_t* configuration;
+  tiny_gea3_erd_client_request_id_t next_request_id;
   uint8_t remaining_retries;
-  uint8_t request_id;
+  tiny_gea3_erd_api_request_id_t request_id;
+  uint16_t active_index;
+  uint8_t priority_burst_count;
+  uint8_t last_address;
+  uint8_t address_run_count;
+  uint8_t gather_responders[32];
+  uint16_t gather_responder_count;
   bool busy;
+  bool sending_requests;
 } tiny_gea3_erd_client_t;
 
 /*!
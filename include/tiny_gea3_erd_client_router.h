@@ -0,0 +1,64 @@
+/*!
+ * @file
+ * @brief Lets several GEA3 ERD clients share one GEA3 interface. Each client is given its own
+ * port and responses are delivered only to the client that sent the matching request.
+ *
+ * The router splits the request IDs evenly between its ports and each client must be configured
+ * with its port's range using tiny_gea3_erd_client_router_configure_port(). The owner of each
+ * request ID is recorded when a request is sent so routing a response is a single table lookup.
+ * Requests sent with an ID outside of the sending port's range are not recorded. Packets that are
+ * not responses and responses to request IDs that have not been recorded are delivered to every
+ * port.
+ */
+
+#ifndef tiny_gea3_erd_client_router_h
+#define tiny_gea3_erd_client_router_h
+
+#include <stdint.h>
+#include "i_tiny_gea_interface.h"
+#include "tiny_event.h"
+#include "tiny_gea3_erd_client.h"
+
+struct tiny_gea3_erd_client_router_t;
+
+typedef struct {
+  i_tiny_gea_interface_t interface;
+
+  tiny_event_t on_receive;
+  struct tiny_gea3_erd_client_router_t* router;
+} tiny_gea3_erd_client_router_port_t;
+
+typedef struct tiny_gea3_erd_client_router_t {
+  tiny_event_subscription_t packet_received;
+  i_tiny_gea_interface_t* gea3_interface;
+  tiny_gea3_erd_client_router_port_t* ports;
+  uint8_t port_count;
+  uint8_t owners[256];
+} tiny_gea3_erd_client_router_t;
+
+/*!
+ * Initialize a router with storage for its ports. There can be at most 255 ports.
+ */
+void tiny_gea3_erd_client_router_init(
+  tiny_gea3_erd_client_router_t* self,
+  i_tiny_gea_interface_t* gea3_interface,
+  tiny_gea3_erd_client_router_port_t* ports,
+  uint8_t port_count);
+
+/*!
+ * Get the interface for a port. This interface should be given to exactly one ERD client.
+ */
+i_tiny_gea_interface_t* tiny_gea3_erd_client_router_port(
+  tiny_gea3_erd_client_router_t* self,
+  uint8_t index);
+
+/*!
+ * Set the request ID range of the configuration for the ERD client that uses a port. Must be
+ * called before the client is initialized.
+ */
+void tiny_gea3_erd_client_router_configure_port(
+  tiny_gea3_erd_client_router_t* self,
+  uint8_t index,
+  tiny_gea3_erd_client_configuration_t* configuration);
+
+#endif
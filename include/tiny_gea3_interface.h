@@ -19,6 +19,7 @@
 #include "hal/i_tiny_uart.h"
 #include "i_tiny_gea_interface.h"
 #include "tiny_event.h"
+#include "tiny_gea_packet_pool.h"
 #include "tiny_queue.h"
 
 typedef struct {
@@ -31,6 +32,9 @@ typedef struct {
   uint8_t* receive_buffer;
 
   tiny_queue_t send_queue;
+  tiny_queue_t priority_send_queue;
+  tiny_queue_t* active_send_queue;
+  const uint8_t* priority_commands;
 
   uint16_t send_crc;
   uint16_t receive_crc;
@@ -52,6 +56,11 @@ typedef struct {
   bool stx_received;
 
   bool ignore_destination_address;
+  const uint8_t* address_filter;
+
+  tiny_gea_packet_pool_t* receive_pool;
+  bool receive_buffer_retained;
+  bool waiting_for_receive_buffer;
 } tiny_gea3_interface_t;
 
 /*!
@@ -67,6 +76,72 @@ void tiny_gea3_interface_init(
   uint8_t receive_buffer_size,
   bool ignore_destination_address);
 
+/*!
+ * Accept packets for every address whose bit is set in a 256-bit (32 byte) bitmap in addition to
+ * the interface's own address and the broadcast address. Bit (address % 8) of byte (address / 8)
+ * corresponds to an address. The bitmap is not copied. Packets for other addresses are dropped as
+ * soon as their destination is received. Pass NULL to remove the filter.
+ */
+void tiny_gea3_interface_set_address_filter(
+  tiny_gea3_interface_t* self,
+  const uint8_t* address_filter);
+
+/*!
+ * Send packets whose command (first payload byte) has its bit set in a 256-bit (32 byte) bitmap
+ * through a separate queue that is served before the send queue. Bit (command % 8) of byte
+ * (command / 8) corresponds to a command. The bitmap is not copied. Priority packets are sent
+ * as soon as the packet being sent completes so short control packets such as acknowledgments
+ * do not wait behind queued bulk packets.
+ */
+void tiny_gea3_interface_use_priority_send_queue(
+  tiny_gea3_interface_t* self,
+  uint8_t* priority_send_queue_buffer,
+  size_t priority_send_queue_buffer_size,
+  const uint8_t* priority_commands);
+
+/*!
+ * Receive into blocks allocated from a packet pool so that received packets can be retained.
+ * Each block also holds the 2 CRC bytes of a received packet so a pool with a maximum payload
+ * length of N receives packets with up to N - 2 bytes of payload. The receive buffer given to
+ * init is no longer used. The pool is not used if it has no free block. Must be called before any
+ * bytes are received.
+ */
+void tiny_gea3_interface_use_receive_pool(
+  tiny_gea3_interface_t* self,
+  tiny_gea_packet_pool_t* pool);
+
+/*!
+ * Retain a packet from an on_receive handler so that it remains valid after the handler returns.
+ * The packet must be released when it is no longer needed. While every block in the pool is
+ * in use, received packets are dropped. Returns false if the packet cannot be retained.
+ */
+bool tiny_gea3_interface_retain(
+  tiny_gea3_interface_t* self,
+  const tiny_gea_packet_t* packet);
+
+/*!
+ * Release a retained packet so that its block is returned to the pool. Releasing a packet that
+ * is not retained has no effect.
+ */
+void tiny_gea3_interface_release(
+  tiny_gea3_interface_t* self,
+  const tiny_gea_packet_t* packet);
+
+/*!
+ * Stop receiving bytes through the UART's on_receive event. The UART driver must instead call
+ * tiny_gea3_interface_byte_received() for each received byte, which avoids publishing an event
+ * per byte.
+ */
+void tiny_gea3_interface_use_direct_byte_receive(
+  tiny_gea3_interface_t* self);
+
+/*!
+ * Handle a received byte. Must be called from the same context as the UART's on_receive.
+ */
+void tiny_gea3_interface_byte_received(
+  tiny_gea3_interface_t* self,
+  uint8_t byte);
+
 /*!
  * Run the interface and publish received packets.
  */
@@ -0,0 +1,58 @@
+/*!
+ * @file
+ * @brief Dispatches received packets to handlers registered for their command byte.
+ *
+ * The demux is the only subscriber to the interface's on_receive event. Each packet is
+ * delivered only to the handlers registered for its first payload byte using a table lookup
+ * so packets with no handlers are discarded without calling anything.
+ */
+
+#ifndef tiny_gea_command_demux_h
+#define tiny_gea_command_demux_h
+
+#include <stdint.h>
+#include "i_tiny_gea_interface.h"
+#include "tiny_event.h"
+
+typedef void (*tiny_gea_command_demux_callback_t)(void* context, const tiny_gea_packet_t* packet);
+
+typedef struct tiny_gea_command_demux_handler_t {
+  struct tiny_gea_command_demux_handler_t* next;
+  tiny_gea_command_demux_callback_t callback;
+  void* context;
+  uint8_t command;
+} tiny_gea_command_demux_handler_t;
+
+typedef struct {
+  tiny_event_subscription_t packet_received;
+  tiny_gea_command_demux_handler_t* handlers[256];
+  tiny_gea_command_demux_handler_t* next_handler;
+} tiny_gea_command_demux_t;
+
+/*!
+ * Initialize a demux for packets received by a GEA interface.
+ */
+void tiny_gea_command_demux_init(
+  tiny_gea_command_demux_t* self,
+  i_tiny_gea_interface_t* gea_interface);
+
+/*!
+ * Register a handler for packets with the given command. More than one handler can be registered
+ * for a command. Handlers for the same command are invoked in the order they were added.
+ */
+void tiny_gea_command_demux_add_handler(
+  tiny_gea_command_demux_t* self,
+  tiny_gea_command_demux_handler_t* handler,
+  uint8_t command,
+  void* context,
+  tiny_gea_command_demux_callback_t callback);
+
+/*!
+ * Unregister a handler. Handlers can be removed from a callback, including handlers that have not
+ * been invoked for the current packet yet.
+ */
+void tiny_gea_command_demux_remove_handler(
+  tiny_gea_command_demux_t* self,
+  tiny_gea_command_demux_handler_t* handler);
+
+#endif
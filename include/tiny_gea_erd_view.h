@@ -0,0 +1,60 @@
+/*!
+ * @file
+ * @brief Zero-copy, bounds-checked view over a sequence of ERD records in a packet payload.
+ *
+ * Each record is an ERD (big endian), a data size and the data. This is the layout used by
+ * GEA3 publications and by GEA2 read responses. Records are validated as they are visited so
+ * that a payload can be validated and consumed in a single pass.
+ */
+
+#ifndef tiny_gea_erd_view_h
+#define tiny_gea_erd_view_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tiny_erd.h"
+#include "tiny_gea_packet.h"
+
+typedef struct {
+  tiny_erd_t erd;
+  const void* data;
+  uint8_t data_size;
+} tiny_gea_erd_view_entry_t;
+
+typedef struct {
+  const uint8_t* next;
+  const uint8_t* end;
+  uint8_t remaining;
+} tiny_gea_erd_view_t;
+
+/*!
+ * Initialize a view over erd_count records stored in entries_size bytes.
+ */
+void tiny_gea_erd_view_init(
+  tiny_gea_erd_view_t* self,
+  const void* entries,
+  uint8_t entries_size,
+  uint8_t erd_count);
+
+/*!
+ * Initialize a view over erd_count records that start at offset and run to the end of the packet
+ * payload. Returns false if the offset is beyond the end of the payload.
+ */
+bool tiny_gea_erd_view_init_from_packet(
+  tiny_gea_erd_view_t* self,
+  const tiny_gea_packet_t* packet,
+  uint8_t offset,
+  uint8_t erd_count);
+
+/*!
+ * Get the next record without copying its data. Returns false when all records have been visited
+ * or if the next record would run past the end of the entries.
+ */
+bool tiny_gea_erd_view_next(tiny_gea_erd_view_t* self, tiny_gea_erd_view_entry_t* entry);
+
+/*!
+ * Returns true if every record has been visited and the records exactly filled the entries.
+ */
+bool tiny_gea_erd_view_complete(const tiny_gea_erd_view_t* self);
+
+#endif
@@ -0,0 +1,104 @@
+/*!
+ * @file
+ * @brief Fixed-size block pool for GEA packets and a queue of packet references.
+ *
+ * Packets are allocated from the pool and handed along by pointer so that queued packets can be
+ * accessed in constant time without copying them. Allocation and freeing are constant time. RAM
+ * use is fixed by the block count and the maximum payload length.
+ *
+ * The pool and the queue are safe to use across an interrupt and a non-interrupt context as long
+ * as all allocations (or enqueues) are made from one context and all frees (or dequeues) are made
+ * from one context. Each side only writes its own index so no critical section is required. Each
+ * block has its own in-use flag byte, set only by allocation and cleared only by freeing, so that a
+ * block being freed twice can be detected without a critical section.
+ */
+
+#ifndef tiny_gea_packet_pool_h
+#define tiny_gea_packet_pool_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tiny_gea_packet.h"
+
+typedef struct {
+  tiny_gea_packet_t** entries;
+  uint8_t capacity;
+  volatile uint8_t head;
+  volatile uint8_t tail;
+} tiny_gea_packet_queue_t;
+
+typedef struct {
+  tiny_gea_packet_queue_t free_blocks;
+  uint8_t* blocks;
+  uint8_t* in_use;
+  uint16_t block_size;
+  uint8_t block_count;
+  uint8_t max_payload_length;
+} tiny_gea_packet_pool_t;
+
+/*!
+ * Size of the block storage required for a pool. This includes one in-use flag byte per block.
+ */
+#define tiny_gea_packet_pool_storage_size(_max_payload_length, _block_count) \
+  ((size_t)((_max_payload_length) + tiny_gea_packet_overhead + 1) * (_block_count))
+
+/*!
+ * Initialize a queue that can hold up to entry_count packet references. There can be at most 127
+ * entries, any more are not used.
+ */
+void tiny_gea_packet_queue_init(
+  tiny_gea_packet_queue_t* self,
+  tiny_gea_packet_t** entries,
+  uint8_t entry_count);
+
+/*!
+ * Add a packet to the back of the queue. Returns false if the queue is full.
+ */
+bool tiny_gea_packet_queue_enqueue(tiny_gea_packet_queue_t* self, tiny_gea_packet_t* packet);
+
+/*!
+ * Remove and return the packet at the front of the queue. Returns NULL if the queue is empty.
+ */
+tiny_gea_packet_t* tiny_gea_packet_queue_dequeue(tiny_gea_packet_queue_t* self);
+
+/*!
+ * Get the packet at the given index without removing it. Index 0 is the front of the queue.
+ * Returns NULL if there is no packet at the index.
+ */
+tiny_gea_packet_t* tiny_gea_packet_queue_peek(tiny_gea_packet_queue_t* self, uint8_t index);
+
+/*!
+ * Number of packets in the queue.
+ */
+uint8_t tiny_gea_packet_queue_count(tiny_gea_packet_queue_t* self);
+
+/*!
+ * Initialize a pool of block_count packets that can each hold max_payload_length bytes of payload.
+ * blocks must be at least tiny_gea_packet_pool_storage_size(max_payload_length, block_count) bytes
+ * and free_list must have block_count entries. There can be at most 127 blocks, any more are not used.
+ */
+void tiny_gea_packet_pool_init(
+  tiny_gea_packet_pool_t* self,
+  void* blocks,
+  uint8_t max_payload_length,
+  uint8_t block_count,
+  tiny_gea_packet_t** free_list);
+
+/*!
+ * Allocate a packet with its payload length set to the maximum. Returns NULL if every block is in
+ * use.
+ */
+tiny_gea_packet_t* tiny_gea_packet_pool_allocate(tiny_gea_packet_pool_t* self);
+
+/*!
+ * Return a packet to the pool. Packets that were not allocated from the pool, and packets that
+ * have already been freed, are ignored.
+ */
+void tiny_gea_packet_pool_free(tiny_gea_packet_pool_t* self, const tiny_gea_packet_t* packet);
+
+/*!
+ * Number of blocks that can be allocated.
+ */
+uint8_t tiny_gea_packet_pool_available(tiny_gea_packet_pool_t* self);
+
+#endif
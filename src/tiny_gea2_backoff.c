@@ -0,0 +1,87 @@
+/*!
+ * @file
+ * @brief
+ */
+
+#include "tiny_gea2_backoff.h"
+#include "tiny_utils.h"
+
+enum {
+  address_slots_mask = 0x1F,
+  base_random_slots = 32,
+  // Like Ethernet's truncated backoff, more doublings only add delay on a bus this small
+  max_supported_exponent = 10,
+  default_seed = 0x2545F491
+};
+
+typedef tiny_gea2_backoff_t self_t;
+
+static uint32_t next_random(self_t* self)
+{
+  uint32_t x = self->random_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  self->random_state = x;
+  return x;
+}
+
+static bool should_shorten(self_t* self, const tiny_gea2_interface_cooldown_args_t* args)
+{
+  if(args->priority && (self->shortened_in_a_row < self->fairness_limit)) {
+    self->shortened_in_a_row++;
+    return true;
+  }
+
+  self->shortened_in_a_row = 0;
+  return false;
+}
+
+static tiny_timer_ticks_t saturated_ticks(uint64_t ticks)
+{
+  const tiny_timer_ticks_t max_ticks = (tiny_timer_ticks_t)-1;
+  return (ticks > max_ticks) ? max_ticks : (tiny_timer_ticks_t)ticks;
+}
+
+static uint32_t random_slots(self_t* self, uint8_t attempt)
+{
+  uint8_t exponent = (attempt > 0) ? (uint8_t)(attempt - 1) : 0;
+
+  if(exponent > self->max_exponent) {
+    exponent = self->max_exponent;
+  }
+
+  return (uint32_t)base_random_slots << exponent;
+}
+
+void tiny_gea2_backoff_init(
+  tiny_gea2_backoff_t* self,
+  uint32_t seed,
+  uint8_t max_exponent,
+  uint8_t fairness_limit)
+{
+  self->random_state = (seed == 0) ? default_seed : seed;
+  self->max_exponent = (max_exponent > max_supported_exponent) ? (uint8_t)max_supported_exponent : max_exponent;
+  self->fairness_limit = fairness_limit;
+  self->shortened_in_a_row = 0;
+}
+
+tiny_timer_ticks_t tiny_gea2_backoff_cooldown(
+  void* context,
+  const tiny_gea2_interface_cooldown_args_t* args)
+{
+  reinterpret(self, context, self_t*);
+  const tiny_gea2_interface_timing_t* timing = args->timing;
+
+  bool shortened = should_shorten(self, args);
+  uint32_t address_slots = shortened ? 0 : (args->address & address_slots_mask);
+
+  if(args->cooldown == tiny_gea2_interface_cooldown_idle) {
+    return saturated_ticks(timing->idle_cooldown_base + (uint64_t)address_slots * timing->cooldown_step);
+  }
+
+  tiny_timer_ticks_t base = shortened ? timing->idle_cooldown_base : timing->collision_cooldown_base;
+  uint32_t slots = address_slots + (next_random(self) % random_slots(self, args->attempt));
+
+  return saturated_ticks(base + (uint64_t)slots * timing->cooldown_step);
+}
@@ -0,0 +1,67 @@
+/*!
+ * @file
+ * @brief
+ */
+
+#include <stddef.h>
+#include "tiny_gea2_diagnostics_recorder.h"
+#include "tiny_utils.h"
+
+typedef tiny_gea2_diagnostics_recorder_t self_t;
+
+static void diagnostics_event_raised(void* context, const void* _args)
+{
+  reinterpret(self, context, self_t*);
+  reinterpret(args, _args, const tiny_gea2_interface_diagnostics_event_args_t*);
+
+  self->entries[self->next] = *args;
+  self->next = (uint16_t)((self->next + 1) % self->entry_count);
+
+  if(self->count < self->entry_count) {
+    self->count++;
+  }
+}
+
+void tiny_gea2_diagnostics_recorder_init(
+  tiny_gea2_diagnostics_recorder_t* self,
+  tiny_gea2_interface_t* gea2_interface,
+  tiny_gea2_interface_diagnostics_event_args_t* entries,
+  uint16_t entry_count)
+{
+  self->entries = entries;
+  self->entry_count = entry_count;
+  self->next = 0;
+  self->count = 0;
+
+  // Without storage nothing can be recorded so diagnostics are left off
+  if(entry_count == 0) {
+    return;
+  }
+
+  tiny_event_subscription_init(&self->diagnostics_event, self, diagnostics_event_raised);
+  tiny_event_subscribe(tiny_gea2_interface_on_diagnostics_event(gea2_interface), &self->diagnostics_event);
+  tiny_gea2_interface_enable_diagnostics(gea2_interface);
+}
+
+uint16_t tiny_gea2_diagnostics_recorder_count(tiny_gea2_diagnostics_recorder_t* self)
+{
+  return self->count;
+}
+
+const tiny_gea2_interface_diagnostics_event_args_t* tiny_gea2_diagnostics_recorder_entry(
+  tiny_gea2_diagnostics_recorder_t* self,
+  uint16_t index)
+{
+  if(index >= self->count) {
+    return NULL;
+  }
+
+  uint16_t oldest = (uint16_t)((self->next + self->entry_count - self->count) % self->entry_count);
+  return &self->entries[(oldest + index) % self->entry_count];
+}
+
+void tiny_gea2_diagnostics_recorder_clear(tiny_gea2_diagnostics_recorder_t* self)
+{
+  self->next = 0;
+  self->count = 0;
+}
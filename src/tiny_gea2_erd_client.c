@@ -7,19 +7,37 @@
 #include "tiny_gea2_erd_api.h"
 #include "tiny_gea2_erd_client.h"
 #include "tiny_gea_constants.h"
+#include "tiny_gea_erd_view.h"
 #include "tiny_stack_allocator.h"
 #include "tiny_utils.h"
 
 enum {
   request_type_read,
   request_type_write,
+  request_type_unacknowledged_write,
   request_type_invalid
 };
 typedef uint8_t request_type_t;
 
+enum {
+  // Only this many requests at the front of the queue are considered for being sent early so that
+  // choosing the next request does not take longer as the queue grows
+  early_send_window = 8
+};
+
+// Every request starts with its request ID, the time it was queued, its deadline and its priority
+// followed by its type and address. The request ID and queue time are not considered when
+// detecting duplicates so that a duplicate can report the ID of the request that is already queued.
+// The deadline and priority are so that a request is never merged into one with different options.
+
 typedef struct
 {
+  tiny_gea2_erd_client_request_id_t request_id;
+  tiny_time_source_ticks_t queued_ticks;
+  tiny_time_source_ticks_t deadline;
+  uint8_t priority;
   request_type_t type;
+  uint8_t address;
 } request_t;
 
 // These request types need to have no padding _or_ we need to memset them to 0
@@ -27,6 +45,10 @@ typedef struct
 
 typedef struct
 {
+  tiny_gea2_erd_client_request_id_t request_id;
+  tiny_time_source_ticks_t queued_ticks;
+  tiny_time_source_ticks_t deadline;
+  uint8_t priority;
   request_type_t type;
   uint8_t address;
   tiny_erd_t erd;
@@ -34,6 +56,10 @@ typedef struct
 
 typedef struct
 {
+  tiny_gea2_erd_client_request_id_t request_id;
+  tiny_time_source_ticks_t queued_ticks;
+  tiny_time_source_ticks_t deadline;
+  uint8_t priority;
   request_type_t type;
   uint8_t address;
   tiny_erd_t erd;
@@ -41,6 +67,8 @@ typedef struct
   uint8_t data[1];
 } write_request_t;
 
+// Unacknowledged writes are stored as write requests
+
 enum {
   request_retries = 2,
   send_retries = 2,
@@ -72,7 +100,7 @@ static void send_read_request(self_t* self)
   read_request_t request;
   uint16_t size;
 
-  tiny_queue_peek(&self->request_queue, &request, &size, 0);
+  tiny_queue_peek(&self->request_queue, &request, &size, self->active_index);
 
   read_request_worker_context_t context = { &request };
 
@@ -90,10 +118,8 @@ static void send_write_request_worker(void* context, tiny_gea_packet_t* packet)
   reinterpret(payload, packet->payload, tiny_gea2_erd_api_write_request_payload_t*);
 
   write_request_t request;
-  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
-
-  uint16_t size;
-  tiny_queue_peek(&self->request_queue, packet->payload, &size, 0);
+  tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, self->active_index);
+  tiny_queue_peek_partial(&self->request_queue, payload->data, request.data_size, offsetof(write_request_t, data), self->active_index);
 
   packet->destination = request.address;
   payload->header.command = tiny_gea2_erd_api_command_write_request;
@@ -103,12 +129,12 @@ static void send_write_request_worker(void* context, tiny_gea_packet_t* packet)
   payload->header.data_size = request.data_size;
 }
 
-static void send_write_request(self_t* self)
+static bool send_write_request(self_t* self)
 {
   write_request_t request;
-  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
+  tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, self->active_index);
 
-  tiny_gea_interface_send(
+  return tiny_gea_interface_send(
     self->gea2_interface,
     request.address,
     sizeof(tiny_gea2_erd_api_write_request_payload_header_t) + request.data_size,
@@ -117,11 +143,18 @@ static void send_write_request(self_t* self)
 }
 
 static void resend_request(self_t* self);
+static void stop_waiting_out_cancelled_request(self_t* self);
 
 static void request_timed_out(void* context)
 {
   reinterpret(self, context, self_t*);
-  resend_request(self);
+
+  if(self->waiting_out_cancelled_request) {
+    stop_waiting_out_cancelled_request(self);
+  }
+  else {
+    resend_request(self);
+  }
 }
 
 static void arm_request_timeout(self_t* self)
@@ -150,7 +183,7 @@ static request_type_t request_type(self_t* self)
 {
   if(request_pending(self)) {
     request_t request;
-    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
+    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
     return request.type;
   }
   else {
@@ -158,103 +191,314 @@ static request_type_t request_type(self_t* self)
   }
 }
 
+static void complete_unacknowledged_write(self_t* self);
+
 static void send_request(self_t* self)
 {
   switch(request_type(self)) {
     case request_type_read:
       send_read_request(self);
+      arm_request_timeout(self);
       break;
 
     case request_type_write:
       send_write_request(self);
+      arm_request_timeout(self);
+      break;
+
+    case request_type_unacknowledged_write:
+      // If the interface cannot accept the packet right now then it is retried like any other request
+      if(send_write_request(self)) {
+        complete_unacknowledged_write(self);
+      }
+      else {
+        arm_request_timeout(self);
+      }
       break;
   }
+}
+
+static bool request_expired(self_t* self)
+{
+  request_t request;
+  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
+
+  if(request.deadline == 0) {
+    return false;
+  }
+
+  tiny_time_source_ticks_t elapsed = (tiny_time_source_ticks_t)(tiny_time_source_ticks(self->timer_group->time_source) - request.queued_ticks);
+  return elapsed >= request.deadline;
+}
+
+static void expire_request(self_t* self);
+
+static bool is_write(const request_t* request)
+{
+  return (request->type == request_type_write) || (request->type == request_type_unacknowledged_write);
+}
+
+static bool is_read_or_write(const request_t* request)
+{
+  return (request->type == request_type_read) || is_write(request);
+}
+
+static bool requests_must_stay_in_order(self_t* self, uint16_t earlier_index, uint16_t later_index)
+{
+  request_t earlier;
+  request_t later;
+  tiny_queue_peek_partial(&self->request_queue, &earlier, sizeof(earlier), 0, earlier_index);
+  tiny_queue_peek_partial(&self->request_queue, &later, sizeof(later), 0, later_index);
+
+  if(!is_read_or_write(&earlier) || !is_read_or_write(&later)) {
+    return false;
+  }
+
+  if((earlier.type == request_type_read) && (later.type == request_type_read)) {
+    return false;
+  }
+
+  read_request_t earlier_read_or_write;
+  read_request_t later_read_or_write;
+  tiny_queue_peek_partial(&self->request_queue, &earlier_read_or_write, sizeof(earlier_read_or_write), 0, earlier_index);
+  tiny_queue_peek_partial(&self->request_queue, &later_read_or_write, sizeof(later_read_or_write), 0, later_index);
+
+  bool same_address =
+    (earlier_read_or_write.address == later_read_or_write.address) ||
+    (earlier_read_or_write.address == tiny_gea_broadcast_address) ||
+    (later_read_or_write.address == tiny_gea_broadcast_address);
+
+  return same_address && (earlier_read_or_write.erd == later_read_or_write.erd);
+}
+
+static bool can_be_sent_early(self_t* self, uint16_t index)
+{
+  for(uint16_t i = 0; i < index; i++) {
+    if(requests_must_stay_in_order(self, i, index)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static uint16_t requests_considered_for_sending_early(self_t* self)
+{
+  uint16_t count = tiny_queue_count(&self->request_queue);
+  return (count > early_send_window) ? (uint16_t)early_send_window : count;
+}
+
+static uint16_t highest_priority_request_index(self_t* self)
+{
+  uint16_t count = requests_considered_for_sending_early(self);
+  uint16_t selected_index = 0;
+  request_t selected;
+  tiny_queue_peek_partial(&self->request_queue, &selected, sizeof(selected), 0, 0);
+
+  for(uint16_t i = 1; i < count; i++) {
+    request_t candidate;
+    tiny_queue_peek_partial(&self->request_queue, &candidate, sizeof(candidate), 0, i);
+
+    if((candidate.priority > selected.priority) && can_be_sent_early(self, i)) {
+      selected_index = i;
+      selected = candidate;
+    }
+  }
+
+  return selected_index;
+}
+
+static void prefer_request_to_last_address(self_t* self, uint8_t priority, uint16_t* index)
+{
+  uint8_t run_limit = self->configuration->address_run_limit;
+
+  if((run_limit == 0) || (self->address_run_count >= run_limit)) {
+    return;
+  }
+
+  uint16_t count = requests_considered_for_sending_early(self);
+
+  for(uint16_t i = 0; i < count; i++) {
+    request_t candidate;
+    tiny_queue_peek_partial(&self->request_queue, &candidate, sizeof(candidate), 0, i);
+
+    if((candidate.address == self->last_address) && (candidate.priority == priority) && can_be_sent_early(self, i)) {
+      *index = i;
+      return;
+    }
+  }
+}
+
+// Selects the oldest request with the highest priority, among the first early_send_window
+// requests, that would not be sent ahead of an older write to, or read of, the same ERD. If
+// enabled, a request of the same priority to the address that was just served is preferred for
+// up to address_run_limit requests in a row. After priority_burst_limit requests have been sent
+// ahead of the oldest request it is sent next so that it cannot be starved.
+static uint16_t next_request_index(self_t* self)
+{
+  uint8_t burst_limit = self->configuration->priority_burst_limit;
+  uint16_t selected_index = 0;
+  request_t selected;
+
+  if((burst_limit == 0) || (self->priority_burst_count < burst_limit)) {
+    selected_index = highest_priority_request_index(self);
+    tiny_queue_peek_partial(&self->request_queue, &selected, sizeof(selected), 0, selected_index);
+
+    if(selected.address != self->last_address) {
+      prefer_request_to_last_address(self, selected.priority, &selected_index);
+    }
+  }
+
+  if(selected_index == 0) {
+    self->priority_burst_count = 0;
+  }
+  else {
+    self->priority_burst_count++;
+  }
+
+  tiny_queue_peek_partial(&self->request_queue, &selected, sizeof(selected), 0, selected_index);
+
+  if(selected.address == self->last_address) {
+    self->address_run_count++;
+  }
+  else {
+    self->last_address = selected.address;
+    self->address_run_count = 1;
+  }
 
-  arm_request_timeout(self);
+  return selected_index;
 }
 
+// Requests that finish as they are selected (unacknowledged writes and expired requests) call back
+// into this when they complete. Rather than recursing once per request, the nested call returns and
+// the loop sends the next request.
 static void send_request_if_not_busy(self_t* self)
 {
-  if(!self->busy && request_pending(self)) {
+  if(self->sending_requests) {
+    return;
+  }
+
+  self->sending_requests = true;
+
+  while(!self->busy && request_pending(self)) {
     self->busy = true;
+    self->active_index = next_request_index(self);
+
+    if(request_expired(self)) {
+      expire_request(self);
+      continue;
+    }
+
     self->remaining_retries = self->configuration->request_retries;
     send_request(self);
   }
+
+  self->sending_requests = false;
 }
 
-static void finish_request(self_t* self)
+static void remove_active_request(self_t* self)
 {
-  tiny_queue_discard(&self->request_queue);
+  tiny_queue_remove(&self->request_queue, self->active_index);
   disarm_request_timeout(self);
   self->busy = false;
-  self->request_id++;
+}
+
+static void finish_request(self_t* self)
+{
+  remove_active_request(self);
   send_request_if_not_busy(self);
 }
 
-static void handle_read_failure(self_t* self)
+static void handle_read_failure(self_t* self, tiny_gea2_erd_client_read_failure_reason_t reason)
 {
   read_request_t request;
   uint16_t size;
-  tiny_queue_peek(&self->request_queue, &request, &size, 0);
+  tiny_queue_peek(&self->request_queue, &request, &size, self->active_index);
 
   tiny_gea2_erd_client_on_activity_args_t args;
   args.address = request.address;
   args.type = tiny_gea2_erd_client_activity_type_read_failed;
-  args.read_failed.request_id = self->request_id;
+  args.read_failed.request_id = request.request_id;
   args.read_failed.erd = request.erd;
-  args.read_failed.reason = tiny_gea2_erd_client_read_failure_reason_retries_exhausted;
+  args.read_failed.reason = reason;
 
   finish_request(self);
 
   tiny_event_publish(&self->on_activity, &args);
 }
 
+typedef struct
+{
+  self_t* self;
+  tiny_gea2_erd_client_write_failure_reason_t reason;
+} handle_write_failure_context_t;
+
 static void handle_write_failure_worker(void* _context, void* allocated_block)
 {
-  self_t* self = _context;
+  reinterpret(context, _context, handle_write_failure_context_t*);
   reinterpret(request, allocated_block, write_request_t*);
+  self_t* self = context->self;
 
   uint16_t size;
-  tiny_queue_peek(&self->request_queue, request, &size, 0);
+  tiny_queue_peek(&self->request_queue, request, &size, self->active_index);
 
   tiny_gea2_erd_client_on_activity_args_t args;
   args.address = request->address;
   args.type = tiny_gea2_erd_client_activity_type_write_failed;
-  args.write_failed.request_id = self->request_id;
+  args.write_failed.request_id = request->request_id;
   args.write_failed.erd = request->erd;
   args.write_failed.data = request->data;
   args.write_failed.data_size = request->data_size;
-  args.write_failed.reason = tiny_gea2_erd_client_read_failure_reason_retries_exhausted;
+  args.write_failed.reason = context->reason;
 
   finish_request(self);
 
   tiny_event_publish(&self->on_activity, &args);
 }
 
-static void handle_write_failure(self_t* self)
+static void handle_write_failure(self_t* self, tiny_gea2_erd_client_write_failure_reason_t reason)
 {
   write_request_t request;
-  tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, 0);
+  tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, self->active_index);
 
-  tiny_stack_allocator_allocate_aligned(request.data_size + offsetof(write_request_t, data), self, handle_write_failure_worker);
+  handle_write_failure_context_t context = { self, reason };
+  tiny_stack_allocator_allocate_aligned(request.data_size + offsetof(write_request_t, data), &context, handle_write_failure_worker);
 }
 
 static void fail_request(self_t* self)
 {
   switch(request_type(self)) {
     case request_type_read:
-      handle_read_failure(self);
+      handle_read_failure(self, tiny_gea2_erd_client_read_failure_reason_retries_exhausted);
       break;
 
     case request_type_write:
-      handle_write_failure(self);
+    case request_type_unacknowledged_write:
+      handle_write_failure(self, tiny_gea2_erd_client_write_failure_reason_retries_exhausted);
+      break;
+  }
+}
+
+static void expire_request(self_t* self)
+{
+  switch(request_type(self)) {
+    case request_type_read:
+      handle_read_failure(self, tiny_gea2_erd_client_read_failure_reason_deadline_expired);
+      break;
+
+    case request_type_write:
+    case request_type_unacknowledged_write:
+      handle_write_failure(self, tiny_gea2_erd_client_write_failure_reason_deadline_expired);
       break;
   }
 }
 
 static void resend_request(self_t* self)
 {
-  if(self->remaining_retries > 0) {
+  if(request_expired(self)) {
+    expire_request(self);
+  }
+  else if(self->remaining_retries > 0) {
     self->remaining_retries--;
     send_request(self);
   }
@@ -263,31 +507,44 @@ static void resend_request(self_t* self)
   }
 }
 
-static void handle_read_response_packet(self_t* self, const tiny_gea_packet_t* packet)
+// Read responses are validated while their single ERD record is parsed
+static bool read_response_view(const tiny_gea_packet_t* packet, tiny_gea_erd_view_t* view)
 {
-  if(request_type(self) == request_type_read) {
-    read_request_t request;
-    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
-
-    if(packet->payload_length >= sizeof(tiny_gea2_erd_api_read_response_payload_t)) {
-      reinterpret(payload, packet->payload, const tiny_gea2_erd_api_read_response_payload_t*);
-      tiny_erd_t erd = (payload->header.erd_msb << 8) + payload->header.erd_lsb;
+  if(packet->payload_length <= offsetof(tiny_gea2_erd_api_read_response_payload_header_t, erd_count)) {
+    return false;
+  }
 
-      if((payload->header.erd_count == 1) &&
-        ((request.address == packet->source) || (request.address == tiny_gea_broadcast_address)) &&
-        (request.erd == erd)) {
-        tiny_gea2_erd_client_on_activity_args_t args;
-        args.address = packet->source;
-        args.type = tiny_gea2_erd_client_activity_type_read_completed;
-        args.read_completed.request_id = self->request_id;
-        args.read_completed.erd = erd;
-        args.read_completed.data_size = payload->header.data_size;
-        args.read_completed.data = payload->data;
+  reinterpret(payload, packet->payload, const tiny_gea2_erd_api_read_response_payload_header_t*);
 
-        finish_request(self);
+  return (payload->erd_count == 1) &&
+    tiny_gea_erd_view_init_from_packet(view, packet, offsetof(tiny_gea2_erd_api_read_response_payload_header_t, erd_msb), payload->erd_count);
+}
 
-        tiny_event_publish(&self->on_activity, &args);
-      }
+static void handle_read_response_packet(self_t* self, const tiny_gea_packet_t* packet)
+{
+  if(request_type(self) == request_type_read) {
+    read_request_t request;
+    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
+
+    tiny_gea_erd_view_t view;
+    tiny_gea_erd_view_entry_t entry;
+
+    if(read_response_view(packet, &view) &&
+      tiny_gea_erd_view_next(&view, &entry) &&
+      tiny_gea_erd_view_complete(&view) &&
+      ((request.address == packet->source) || (request.address == tiny_gea_broadcast_address)) &&
+      (request.erd == entry.erd)) {
+      tiny_gea2_erd_client_on_activity_args_t args;
+      args.address = packet->source;
+      args.type = tiny_gea2_erd_client_activity_type_read_completed;
+      args.read_completed.request_id = request.request_id;
+      args.read_completed.erd = entry.erd;
+      args.read_completed.data_size = entry.data_size;
+      args.read_completed.data = entry.data;
+
+      finish_request(self);
+
+      tiny_event_publish(&self->on_activity, &args);
     }
   }
 }
@@ -304,12 +561,12 @@ static void handle_write_response_packet_worker(void* _context, void* allocated_
   reinterpret(request, allocated_block, write_request_t*);
 
   uint16_t size;
-  tiny_queue_peek(&context->self->request_queue, request, &size, 0);
+  tiny_queue_peek(&context->self->request_queue, request, &size, context->self->active_index);
 
   tiny_gea2_erd_client_on_activity_args_t args;
   args.address = context->client_address;
   args.type = tiny_gea2_erd_client_activity_type_write_completed;
-  args.write_completed.request_id = context->self->request_id;
+  args.write_completed.request_id = request->request_id;
   args.write_completed.erd = request->erd;
   args.write_completed.data = request->data;
   args.write_completed.data_size = request->data_size;
@@ -319,11 +576,41 @@ static void handle_write_response_packet_worker(void* _context, void* allocated_
   tiny_event_publish(&context->self->on_activity, &args);
 }
 
+static void complete_unacknowledged_write_worker(void* context, void* allocated_block)
+{
+  reinterpret(self, context, self_t*);
+  reinterpret(request, allocated_block, write_request_t*);
+
+  uint16_t size;
+  tiny_queue_peek(&self->request_queue, request, &size, self->active_index);
+
+  tiny_gea2_erd_client_on_activity_args_t args;
+  args.address = request->address;
+  args.type = tiny_gea2_erd_client_activity_type_write_completed;
+  args.write_completed.request_id = request->request_id;
+  args.write_completed.erd = request->erd;
+  args.write_completed.data = request->data;
+  args.write_completed.data_size = request->data_size;
+
+  // Publish before sending the next request so that back-to-back unacknowledged writes complete in
+  // the order they were sent
+  remove_active_request(self);
+  tiny_event_publish(&self->on_activity, &args);
+  send_request_if_not_busy(self);
+}
+
+static void complete_unacknowledged_write(self_t* self)
+{
+  uint16_t size;
+  tiny_queue_peek_size(&self->request_queue, &size, self->active_index);
+  tiny_stack_allocator_allocate_aligned(size, self, complete_unacknowledged_write_worker);
+}
+
 static void handle_write_response_packet(self_t* self, const tiny_gea_packet_t* packet)
 {
   if(request_type(self) == request_type_write) {
     write_request_t request;
-    tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, 0);
+    tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, self->active_index);
 
     if(packet->payload_length == sizeof(tiny_gea2_erd_api_write_response_payload_t)) {
       reinterpret(payload, packet->payload, const tiny_gea2_erd_api_write_response_payload_t*);
@@ -339,27 +626,53 @@ static void handle_write_response_packet(self_t* self, const tiny_gea_packet_t*
   }
 }
 
-static bool valid_read_response(const tiny_gea_packet_t* packet)
+static bool valid_write_response(const tiny_gea_packet_t* packet)
 {
-  if(packet->payload_length < sizeof(tiny_gea2_erd_api_read_response_payload_header_t)) {
+  if(packet->payload_length != sizeof(tiny_gea2_erd_api_write_response_payload_t)) {
     return false;
   }
 
-  reinterpret(payload, packet->payload, const tiny_gea2_erd_api_read_response_payload_t*);
+  reinterpret(payload, packet->payload, const tiny_gea2_erd_api_write_response_payload_t*);
 
-  return (payload->header.erd_count == 1) &&
-    (packet->payload_length == sizeof(tiny_gea2_erd_api_read_response_payload_header_t) + payload->header.data_size);
+  return payload->erd_count == 1;
 }
 
-static bool valid_write_response(const tiny_gea_packet_t* packet)
+static bool response_erd(const tiny_gea_packet_t* packet, tiny_erd_t* erd)
 {
-  if(packet->payload_length != sizeof(tiny_gea2_erd_api_write_response_payload_t)) {
-    return false;
+  switch(packet->payload[0]) {
+    case tiny_gea2_erd_api_command_read_response: {
+      tiny_gea_erd_view_t view;
+      tiny_gea_erd_view_entry_t entry;
+
+      if(read_response_view(packet, &view) && tiny_gea_erd_view_next(&view, &entry)) {
+        *erd = entry.erd;
+        return true;
+      }
+    } break;
+
+    case tiny_gea2_erd_api_command_write_response:
+      if(valid_write_response(packet)) {
+        reinterpret(payload, packet->payload, const tiny_gea2_erd_api_write_response_payload_t*);
+        *erd = (tiny_erd_t)((payload->erd_msb << 8) + payload->erd_lsb);
+        return true;
+      }
+      break;
   }
 
-  reinterpret(payload, packet->payload, const tiny_gea2_erd_api_write_response_payload_t*);
+  return false;
+}
 
-  return payload->erd_count == 1;
+// A late response to the cancelled request ends the wait without being published so that it cannot
+// complete the next request to the same address and ERD
+static void handle_response_to_cancelled_request(self_t* self, const tiny_gea_packet_t* packet)
+{
+  tiny_erd_t erd;
+
+  if(response_erd(packet, &erd) &&
+    ((self->cancelled_address == packet->source) || (self->cancelled_address == tiny_gea_broadcast_address)) &&
+    (self->cancelled_erd == erd)) {
+    stop_waiting_out_cancelled_request(self);
+  }
 }
 
 static void packet_received(void* _self, const void* _args)
@@ -367,11 +680,14 @@ static void packet_received(void* _self, const void* _args)
   self_t* self = _self;
   const tiny_gea_interface_on_receive_args_t* args = _args;
 
+  if(self->waiting_out_cancelled_request) {
+    handle_response_to_cancelled_request(self, args->packet);
+    return;
+  }
+
   switch(args->packet->payload[0]) {
     case tiny_gea2_erd_api_command_read_response:
-      if(valid_read_response(args->packet)) {
-        handle_read_response_packet(self, args->packet);
-      }
+      handle_read_response_packet(self, args->packet);
       break;
 
     case tiny_gea2_erd_api_command_write_response:
@@ -389,6 +705,7 @@ typedef struct
   requests_conflict_predicate_t requests_conflict_predicate;
   uint16_t i;
   uint16_t requestSize;
+  tiny_gea2_erd_client_request_id_t queued_request_id;
   bool request_already_queued;
   bool request_conflict_found;
 } enqueue_request_if_unique_context_t;
@@ -402,7 +719,15 @@ static void enqueue_request_if_unique_worker(void* _context, void* allocated_blo
 
   context->request_already_queued =
     (context->requestSize == size) &&
-    (memcmp(context->request, allocated_block, size) == 0);
+    (memcmp(
+       (const uint8_t*)context->request + offsetof(request_t, deadline),
+       (const uint8_t*)allocated_block + offsetof(request_t, deadline),
+       size - offsetof(request_t, deadline)) == 0);
+
+  if(context->request_already_queued) {
+    reinterpret(queued_request, allocated_block, const request_t*);
+    context->queued_request_id = queued_request->request_id;
+  }
 
   if(context->requests_conflict_predicate) {
     context->request_conflict_found = context->requests_conflict_predicate(context->request, allocated_block);
@@ -411,9 +736,9 @@ static void enqueue_request_if_unique_worker(void* _context, void* allocated_blo
 
 static bool enqueue_request_if_unique(
   self_t* self,
-  const void* request,
+  request_t* request,
   uint16_t requestSize,
-  uint16_t* index,
+  tiny_gea2_erd_client_request_id_t* request_id,
   requests_conflict_predicate_t requests_conflict_predicate)
 {
   uint16_t count = tiny_queue_count(&self->request_queue);
@@ -435,7 +760,7 @@ static bool enqueue_request_if_unique(
     tiny_stack_allocator_allocate_aligned(element_size, &context, enqueue_request_if_unique_worker);
 
     if(context.request_already_queued) {
-      *index = i;
+      *request_id = context.queued_request_id;
       return true;
     }
 
@@ -444,8 +769,16 @@ static bool enqueue_request_if_unique(
     }
   }
 
-  *index = count;
-  return tiny_queue_enqueue(&self->request_queue, request, requestSize);
+  request->request_id = self->next_request_id;
+  request->queued_ticks = tiny_time_source_ticks(self->timer_group->time_source);
+  *request_id = request->request_id;
+
+  if(!tiny_queue_enqueue(&self->request_queue, request, requestSize)) {
+    return false;
+  }
+
+  self->next_request_id++;
+  return true;
 }
 
 static bool read_request_conflicts(const request_t* new_request, const request_t* queued_request)
@@ -454,6 +787,7 @@ static bool read_request_conflicts(const request_t* new_request, const request_t
 
   switch(queued_request->type) {
     case request_type_write:
+    case request_type_unacknowledged_write:
       return true;
 
     default:
@@ -461,35 +795,47 @@ static bool read_request_conflicts(const request_t* new_request, const request_t
   }
 }
 
-static bool read(i_tiny_gea2_erd_client_t* _self, tiny_gea2_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd)
+static const tiny_gea2_erd_client_request_options_t default_request_options = { 0 };
+
+static bool read_with_options(
+  i_tiny_gea2_erd_client_t* _self,
+  tiny_gea2_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const tiny_gea2_erd_client_request_options_t* options)
 {
   reinterpret(self, _self, self_t*);
 
-  uint16_t index;
   read_request_t request;
+  memset(&request, 0, sizeof(request));
+  request.deadline = options->deadline;
+  request.priority = options->priority;
   request.type = request_type_read;
   request.address = address;
   request.erd = erd;
   bool request_added_or_already_queued = enqueue_request_if_unique(
     self,
-    &request,
+    (request_t*)&request,
     sizeof(request),
-    &index,
+    request_id,
     read_request_conflicts);
 
-  *request_id = index + self->request_id;
-
   send_request_if_not_busy(self);
 
   return request_added_or_already_queued;
 }
 
+static bool read(i_tiny_gea2_erd_client_t* _self, tiny_gea2_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd)
+{
+  return read_with_options(_self, request_id, address, erd, &default_request_options);
+}
+
 typedef struct
 {
   self_t* self;
+  const tiny_gea2_erd_client_request_options_t* options;
   const void* data;
   tiny_erd_t erd;
-  uint16_t index;
   tiny_gea2_erd_client_request_id_t request_id;
   uint8_t address;
   uint8_t data_size;
@@ -502,6 +848,7 @@ static bool write_request_conflicts(const request_t* new_request, const request_
 
   switch(queued_request->type) {
     case request_type_write:
+    case request_type_unacknowledged_write:
     case request_type_read:
       return true;
 
@@ -515,29 +862,38 @@ static void write_worker(void* _context, void* allocated_block)
   reinterpret(context, _context, write_context_t*);
   reinterpret(request, allocated_block, write_request_t*);
 
-  request->type = request_type_write;
+  memset(request, 0, offsetof(write_request_t, data));
+  request->deadline = context->options->deadline;
+  request->priority = context->options->priority;
+  request->type = context->options->unacknowledged ? request_type_unacknowledged_write : request_type_write;
   request->address = context->address;
   request->erd = context->erd;
   request->data_size = context->data_size;
   memcpy(request->data, context->data, context->data_size);
   context->request_added_or_already_queued = enqueue_request_if_unique(
     context->self,
-    request,
+    (request_t*)request,
     offsetof(write_request_t, data) + context->data_size,
-    &context->index,
+    &context->request_id,
     write_request_conflicts);
 
-  context->request_id = context->index + context->self->request_id;
-
   send_request_if_not_busy(context->self);
 }
 
-static bool write(i_tiny_gea2_erd_client_t* _self, tiny_gea2_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd, const void* data, uint8_t data_size)
+static bool write_with_options(
+  i_tiny_gea2_erd_client_t* _self,
+  tiny_gea2_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const void* data,
+  uint8_t data_size,
+  const tiny_gea2_erd_client_request_options_t* options)
 {
   reinterpret(self, _self, self_t*);
 
   write_context_t context;
   context.self = self;
+  context.options = options;
   context.address = address;
   context.erd = erd;
   context.data = data;
@@ -550,13 +906,90 @@ static bool write(i_tiny_gea2_erd_client_t* _self, tiny_gea2_erd_client_request_
   return context.request_added_or_already_queued;
 }
 
+static bool write(i_tiny_gea2_erd_client_t* _self, tiny_gea2_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd, const void* data, uint8_t data_size)
+{
+  return write_with_options(_self, request_id, address, erd, data, data_size, &default_request_options);
+}
+
+static bool find_request(self_t* self, tiny_gea2_erd_client_request_id_t request_id, uint16_t* index)
+{
+  uint16_t count = tiny_queue_count(&self->request_queue);
+
+  for(uint16_t i = 0; i < count; i++) {
+    request_t request;
+    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, i);
+
+    if(request.request_id == request_id) {
+      *index = i;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// GEA2 responses carry no request ID so a late response to a cancelled in-flight request could
+// complete the next request to the same address and ERD. The cancelled request is removed but the
+// client stays busy until its response arrives or its timeout expires.
+static void wait_out_cancelled_request(self_t* self)
+{
+  read_request_t request;
+  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
+
+  self->cancelled_address = request.address;
+  self->cancelled_erd = request.erd;
+  self->waiting_out_cancelled_request = true;
+
+  tiny_queue_remove(&self->request_queue, self->active_index);
+}
+
+static void stop_waiting_out_cancelled_request(self_t* self)
+{
+  self->waiting_out_cancelled_request = false;
+  disarm_request_timeout(self);
+  self->busy = false;
+  send_request_if_not_busy(self);
+}
+
+static bool cancel(i_tiny_gea2_erd_client_t* _self, tiny_gea2_erd_client_request_id_t request_id)
+{
+  reinterpret(self, _self, self_t*);
+
+  uint16_t index;
+  if(!find_request(self, request_id, &index)) {
+    return false;
+  }
+
+  bool request_in_flight = self->busy && !self->waiting_out_cancelled_request;
+
+  if(request_in_flight && (index == self->active_index)) {
+    wait_out_cancelled_request(self);
+  }
+  else {
+    tiny_queue_remove(&self->request_queue, index);
+
+    if(request_in_flight && (index < self->active_index)) {
+      self->active_index--;
+    }
+  }
+
+  return true;
+}
+
 static i_tiny_event_t* on_activity(i_tiny_gea2_erd_client_t* _self)
 {
   reinterpret(self, _self, self_t*);
   return &self->on_activity.interface;
 }
 
-static const i_tiny_gea2_erd_client_api_t api = { read, write, on_activity };
+static const i_tiny_gea2_erd_client_api_t api = {
+  read,
+  write,
+  on_activity,
+  read_with_options,
+  write_with_options,
+  cancel
+};
 
 void tiny_gea2_erd_client_init(
   self_t* self,
@@ -569,10 +1002,16 @@ void tiny_gea2_erd_client_init(
   self->interface.api = &api;
 
   self->busy = false;
+  self->sending_requests = false;
+  self->waiting_out_cancelled_request = false;
   self->gea2_interface = gea2_interface;
   self->configuration = configuration;
   self->timer_group = timer_group;
-  self->request_id = 0;
+  self->next_request_id = 0;
+  self->active_index = 0;
+  self->priority_burst_count = 0;
+  self->last_address = tiny_gea_broadcast_address;
+  self->address_run_count = 0;
 
   tiny_queue_init(&self->request_queue, queue_buffer, queue_buffer_size);
 
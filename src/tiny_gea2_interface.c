@@ -13,6 +13,16 @@
  * this operation is pending the interrupt context is not free to begin
  * sending any additional packets.
  *
+ * When a priority send queue is used, the non-interrupt context selects the
+ * queue to send from before setting the send in progress flag and does not
+ * change the selection until the send has completed. The interrupt context
+ * only peeks from the selected queue.
+ *
+ * The same applies to the packet selected with send.index when destinations
+ * are rotated. The interrupt context sets send.deferred together with
+ * send.completed when a failed packet should be left in the queue so that the
+ * non-interrupt context can select a packet for another destination.
+ *
  * The non-interrupt context sets the send.in_progress flag and clears
  * the send.completed flag. While send.completed remains false, the first
  * element of the queue is not modified.
@@ -69,9 +79,22 @@
 #include "tiny_utils.h"
 
 enum {
+  gea2_reference_baud = 19200,
   gea2_reflection_timeout_msec = 6,
   gea2_ack_timeout_msec = 8,
   gea2_interbyte_timeout_msec = 6,
+  gea2_idle_cooldown_base_msec = 10,
+  gea2_collision_cooldown_base_msec = 43,
+  gea2_cooldown_step_msec = 1
+};
+
+static const tiny_gea2_interface_timing_t default_timing = {
+  .reflection_timeout = gea2_reflection_timeout_msec,
+  .ack_timeout = gea2_ack_timeout_msec,
+  .interbyte_timeout = gea2_interbyte_timeout_msec,
+  .idle_cooldown_base = gea2_idle_cooldown_base_msec,
+  .collision_cooldown_base = gea2_collision_cooldown_base_msec,
+  .cooldown_step = gea2_cooldown_step_msec
 };
 
 typedef tiny_gea2_interface_t self_t;
@@ -117,23 +140,92 @@ static self_t* interface_from_fsm(tiny_fsm_t* fsm)
   return container_of(self_t, fsm, fsm);
 }
 
+static void raise_diagnostics_event(
+  self_t* self,
+  tiny_gea2_interface_diagnostics_event_type_t type,
+  uint8_t address,
+  uint8_t attempt,
+  bool broadcast)
+{
+  if(!self->diagnostics_enabled) {
+    return;
+  }
+
+  tiny_gea2_interface_diagnostics_event_args_t args = {
+    .timestamp = tiny_time_source_ticks(self->timer_group.time_source),
+    .type = type,
+    .address = address,
+    .attempt = attempt,
+    .broadcast = broadcast
+  };
+  tiny_event_publish(&self->on_diagnostics_event, &args);
+}
+
+static void raise_send_diagnostics_event(self_t* self, tiny_gea2_interface_diagnostics_event_type_t type)
+{
+  if(!self->diagnostics_enabled) {
+    return;
+  }
+
+  uint8_t destination;
+  tiny_queue_peek_partial(self->send.active_queue, &destination, sizeof(destination), offsetof(tiny_gea_packet_t, destination), self->send.index);
+  raise_diagnostics_event(self, type, destination, (uint8_t)(self->retries - self->send.retries), destination == tiny_gea_broadcast_address);
+}
+
+// The source and destination of a packet that timed out are only known if they were received
+static void raise_interbyte_timeout_diagnostics_event(self_t* self)
+{
+  reinterpret(packet, self->receive.buffer, const tiny_gea_packet_t*);
+  bool source_received = self->receive.count > offsetof(tiny_gea_packet_t, source);
+  bool destination_received = self->receive.count > offsetof(tiny_gea_packet_t, destination);
+
+  raise_diagnostics_event(
+    self,
+    tiny_gea2_interface_diagnostics_event_interbyte_timeout,
+    source_received ? packet->source : tiny_gea_broadcast_address,
+    0,
+    destination_received && (packet->destination == tiny_gea_broadcast_address));
+}
+
 static void byte_received(void* context, const void* _args)
 {
   self_t* self = context;
   const tiny_uart_on_receive_args_t* args = _args;
 
-  tiny_fsm_send_signal(&self->fsm, signal_byte_received, &args->byte);
+  tiny_gea2_interface_byte_received(self, args->byte);
 }
 
 #define needs_escape(_byte) ((_byte & 0xFC) == tiny_gea_esc)
 
+static void transmit_gate_timeout(void* context)
+{
+  self_t* self = context;
+  tiny_fsm_send_signal(&self->fsm, signal_send_ready, NULL);
+}
+
+static bool transmit_gate_is_open(self_t* self)
+{
+  if(!self->transmit_gate) {
+    return true;
+  }
+
+  tiny_timer_ticks_t ticks = self->transmit_gate(self->transmit_gate_context);
+
+  if(ticks > 0) {
+    tiny_timer_start(&self->timer_group, &self->timer, ticks, self, transmit_gate_timeout);
+    return false;
+  }
+
+  return true;
+}
+
 static void state_idle(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal, const void* data)
 {
   self_t* self = interface_from_fsm(fsm);
   switch(signal) {
     case tiny_fsm_signal_entry:
     case signal_send_ready:
-      if(!self->send.completed && self->send.in_progress) {
+      if(!self->send.completed && self->send.in_progress && transmit_gate_is_open(self)) {
         tiny_fsm_transition(fsm, state_send);
       }
       break;
@@ -155,9 +247,34 @@ static void state_idle(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal, const vo
   }
 }
 
+static void record_byte_time(self_t* self)
+{
+  self->last_byte_time = tiny_time_source_ticks(self->timer_group.time_source);
+}
+
+// The interbyte and reflection timers are not restarted for every byte. Instead the time of the
+// last byte is recorded and, when the timer expires, it is restarted for the remainder of the
+// timeout if a byte was sent or received since it was started
+static bool timeout_was_extended(self_t* self, tiny_timer_ticks_t timeout, tiny_timer_callback_t callback)
+{
+  tiny_timer_ticks_t elapsed = (tiny_time_source_ticks_t)(tiny_time_source_ticks(self->timer_group.time_source) - self->last_byte_time);
+
+  if(elapsed < timeout) {
+    tiny_timer_start(&self->timer_group, &self->timer, timeout - elapsed, self, callback);
+    return true;
+  }
+
+  return false;
+}
+
 static void reflection_timeout(void* context)
 {
   self_t* self = context;
+
+  if(timeout_was_extended(self, self->timing->reflection_timeout, reflection_timeout)) {
+    return;
+  }
+
   tiny_fsm_send_signal(&self->fsm, signal_reflection_timeout, NULL);
 }
 
@@ -175,16 +292,21 @@ static bool determine_byte_to_send_considering_escapes(self_t* self, uint8_t byt
   return !self->send.escaped;
 }
 
-static void send_next_byte(self_t* self)
+static void start_reflection_timeout_timer(self_t* self)
 {
-  uint8_t byte_to_send = 0;
-
   tiny_timer_start(
     &self->timer_group,
     &self->timer,
-    gea2_reflection_timeout_msec,
+    self->timing->reflection_timeout,
     self,
     reflection_timeout);
+}
+
+static void send_next_byte(self_t* self)
+{
+  uint8_t byte_to_send = 0;
+
+  record_byte_time(self);
 
   switch(self->send.state) {
     case send_state_stx:
@@ -194,7 +316,7 @@ static void send_next_byte(self_t* self)
 
     case send_state_destination: {
       uint8_t destination;
-      tiny_queue_peek_partial(&self->send.queue, &destination, sizeof(destination), self->send.offset, 0);
+      tiny_queue_peek_partial(self->send.active_queue, &destination, sizeof(destination), self->send.offset, self->send.index);
       if(determine_byte_to_send_considering_escapes(self, destination, &byte_to_send)) {
         self->send.crc = tiny_crc16_byte(self->send.crc, byte_to_send);
         self->send.offset++;
@@ -214,7 +336,7 @@ static void send_next_byte(self_t* self)
 
     case send_state_source: {
       uint8_t source;
-      tiny_queue_peek_partial(&self->send.queue, &source, sizeof(source), self->send.offset, 0);
+      tiny_queue_peek_partial(self->send.active_queue, &source, sizeof(source), self->send.offset, self->send.index);
       if(determine_byte_to_send_considering_escapes(self, source, &byte_to_send)) {
         self->send.crc = tiny_crc16_byte(self->send.crc, byte_to_send);
         self->send.offset++;
@@ -230,7 +352,7 @@ static void send_next_byte(self_t* self)
 
     case send_state_data: {
       uint8_t data;
-      tiny_queue_peek_partial(&self->send.queue, &data, sizeof(data), self->send.offset, 0);
+      tiny_queue_peek_partial(self->send.active_queue, &data, sizeof(data), self->send.offset, self->send.index);
       if(determine_byte_to_send_considering_escapes(self, data, &byte_to_send)) {
         self->send.crc = tiny_crc16_byte(self->send.crc, byte_to_send);
         self->send.offset++;
@@ -261,22 +383,61 @@ static void send_next_byte(self_t* self)
       break;
   }
 
-  self->send.expected_reflection = byte_to_send;
+  // The reflection may be received before tiny_uart_send() returns so it must be expected first
+  uint8_t tail = (self->send.reflection_head + self->send.reflections_in_flight) % tiny_gea2_interface_max_send_window;
+  self->send.expected_reflections[tail] = byte_to_send;
+  self->send.reflections_in_flight++;
+
   tiny_uart_send(self->uart, byte_to_send);
 }
 
+static void fill_send_window(self_t* self)
+{
+  while((self->fsm.current == state_send) &&
+    (self->send.state != send_state_done_sending) &&
+    (self->send.reflections_in_flight < self->send.window)) {
+    send_next_byte(self);
+  }
+}
+
+static bool reflection_is_expected(self_t* self, uint8_t byte)
+{
+  if(self->send.reflections_in_flight == 0) {
+    return false;
+  }
+
+  if(byte != self->send.expected_reflections[self->send.reflection_head]) {
+    return false;
+  }
+
+  self->send.reflection_head = (self->send.reflection_head + 1) % tiny_gea2_interface_max_send_window;
+  self->send.reflections_in_flight--;
+
+  return true;
+}
+
 static void handle_send_success(self_t* self)
 {
+  raise_send_diagnostics_event(self, tiny_gea2_interface_diagnostics_event_packet_sent);
   self->send.completed = true;
   tiny_fsm_transition(&self->fsm, state_idle_cooldown);
 }
 
-static void handle_send_failure(self_t* self)
+static void handle_send_failure(self_t* self, tiny_gea2_interface_diagnostics_event_type_t reason)
 {
+  raise_send_diagnostics_event(self, reason);
+
   if(self->send.retries > 0) {
     self->send.retries--;
+
+    // Let the non-interrupt context send a packet to another destination before retrying
+    if(self->send.can_rotate) {
+      self->send.deferred = true;
+      self->send.completed = true;
+    }
   }
   else {
+    raise_send_diagnostics_event(self, tiny_gea2_interface_diagnostics_event_retries_exhausted);
     self->send.completed = true;
   }
 
@@ -293,16 +454,19 @@ static void state_send(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal, const vo
       self->send.offset = 0;
       self->send.escaped = false;
       self->send.crc = tiny_gea_crc_seed;
+      self->send.reflection_head = 0;
+      self->send.reflections_in_flight = 0;
 
-      send_next_byte(self);
+      start_reflection_timeout_timer(self);
+      fill_send_window(self);
       break;
 
     case signal_byte_received: {
       const uint8_t* byte = data;
-      if(*byte == self->send.expected_reflection) {
-        if(self->send.state == send_state_done_sending) {
+      if(reflection_is_expected(self, *byte)) {
+        if((self->send.state == send_state_done_sending) && (self->send.reflections_in_flight == 0)) {
           uint8_t destination;
-          tiny_queue_peek_partial(&self->send.queue, &destination, sizeof(destination), offsetof(tiny_gea_packet_t, destination), 0);
+          tiny_queue_peek_partial(self->send.active_queue, &destination, sizeof(destination), offsetof(tiny_gea_packet_t, destination), self->send.index);
 
           if(destination == tiny_gea_broadcast_address) {
             handle_send_success(self);
@@ -312,16 +476,17 @@ static void state_send(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal, const vo
           }
         }
         else {
-          send_next_byte(self);
+          record_byte_time(self);
+          fill_send_window(self);
         }
       }
       else {
-        handle_send_failure(self);
+        handle_send_failure(self, tiny_gea2_interface_diagnostics_event_collision);
       }
     } break;
 
     case signal_reflection_timeout:
-      handle_send_failure(self);
+      handle_send_failure(self, tiny_gea2_interface_diagnostics_event_reflection_timeout);
       tiny_fsm_transition(fsm, state_idle_cooldown);
       break;
   }
@@ -338,7 +503,7 @@ static void start_ack_timeout_timer(self_t* self)
   tiny_timer_start(
     &self->timer_group,
     &self->timer,
-    gea2_ack_timeout_msec,
+    self->timing->ack_timeout,
     self,
     ack_timeout);
 }
@@ -358,12 +523,12 @@ static void state_wait_for_ack(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal,
         handle_send_success(self);
       }
       else {
-        handle_send_failure(self);
+        handle_send_failure(self, tiny_gea2_interface_diagnostics_event_collision);
       }
     } break;
 
     case signal_ack_timeout:
-      handle_send_failure(self);
+      handle_send_failure(self, tiny_gea2_interface_diagnostics_event_ack_timeout);
       break;
   }
 }
@@ -384,10 +549,28 @@ static bool received_packet_has_valid_length(self_t* self)
   return (packet->payload_length == self->receive.count + unbuffered_bytes);
 }
 
+static bool destination_is_accepted(self_t* self, uint8_t destination)
+{
+  return (destination == self->address) ||
+    (destination == tiny_gea_broadcast_address) ||
+    self->ignore_destination_address ||
+    (self->address_filter && (self->address_filter[destination >> 3] & (1 << (destination & 7))));
+}
+
 static void buffer_received_byte(self_t* self, uint8_t byte)
 {
+  // Bytes are not buffered for a packet that is not addressed to us
+  if(self->receive.dropping) {
+    return;
+  }
+
   if(self->receive.count == 0) {
     self->receive.crc = tiny_gea_crc_seed;
+
+    if(!destination_is_accepted(self, byte)) {
+      self->receive.dropping = true;
+      return;
+    }
   }
 
   if(self->receive.count < self->receive.buffer_size) {
@@ -402,9 +585,7 @@ static void buffer_received_byte(self_t* self, uint8_t byte)
 static bool received_packet_is_addressed_to_me(self_t* self)
 {
   reinterpret(packet, self->receive.buffer, tiny_gea_packet_t*);
-  return (packet->destination == self->address) ||
-    (packet->destination == tiny_gea_broadcast_address) ||
-    self->ignore_destination_address;
+  return !self->receive.dropping && destination_is_accepted(self, packet->destination);
 }
 
 static void send_ack(self_t* self, uint8_t address)
@@ -431,23 +612,22 @@ static void process_received_byte(self_t* self, const uint8_t byte)
 
     case tiny_gea_stx:
       self->receive.count = 0;
+      self->receive.dropping = false;
       break;
 
     case tiny_gea_etx:
-      if(!received_packet_has_minimum_valid_length(self) || !received_packet_has_valid_length(self)) {
-        break;
-      }
-
-      if(!received_packet_has_valid_crc(self)) {
+      if(!received_packet_is_addressed_to_me(self)) {
         break;
       }
 
-      if(!received_packet_is_addressed_to_me(self)) {
+      if(!received_packet_has_minimum_valid_length(self) || !received_packet_has_valid_length(self) || !received_packet_has_valid_crc(self)) {
+        raise_diagnostics_event(self, tiny_gea2_interface_diagnostics_event_packet_dropped, packet->source, 0, packet->destination == tiny_gea_broadcast_address);
         break;
       }
 
       packet->payload_length -= tiny_gea_packet_transmission_overhead;
       self->receive.packet_ready = true;
+      raise_diagnostics_event(self, tiny_gea2_interface_diagnostics_event_packet_received, packet->source, 0, packet->destination == tiny_gea_broadcast_address);
 
       send_ack(self, packet->destination);
 
@@ -460,9 +640,23 @@ static void process_received_byte(self_t* self, const uint8_t byte)
   }
 }
 
-static tiny_timer_ticks_t get_collision_timeout(uint8_t address, uint8_t pseudo_random_number)
+static tiny_timer_ticks_t get_cooldown(self_t* self, tiny_gea2_interface_cooldown_t cooldown)
 {
-  return 43 + (address & 0x1F) + ((pseudo_random_number ^ address) & 0x1F);
+  bool sending = self->send.in_progress && !self->send.completed;
+
+  tiny_gea2_interface_cooldown_args_t args = {
+    .timing = self->timing,
+    .cooldown = cooldown,
+    .address = self->address,
+    .attempt = sending ? (uint8_t)(self->retries - self->send.retries) : 0,
+    .priority = sending && (self->send.active_queue == &self->send.priority_queue)
+  };
+
+  if(self->cooldown_policy) {
+    return self->cooldown_policy(self->cooldown_policy_context, &args);
+  }
+
+  return tiny_gea2_interface_default_cooldown_policy(self->timer_group.time_source, &args);
 }
 
 static void collision_idle_timeout(void* context)
@@ -473,8 +667,7 @@ static void collision_idle_timeout(void* context)
 
 static void start_collision_idle_timeout_timer(self_t* self)
 {
-  uint8_t current_ticks = (uint8_t)tiny_time_source_ticks(self->timer_group.time_source);
-  tiny_timer_ticks_t collision_timeout_ticks = get_collision_timeout(self->address, current_ticks);
+  tiny_timer_ticks_t collision_timeout_ticks = get_cooldown(self, tiny_gea2_interface_cooldown_collision);
 
   tiny_timer_start(
     &self->timer_group,
@@ -509,6 +702,11 @@ static void state_collision_cooldown(tiny_fsm_t* fsm, const tiny_fsm_signal_t si
 static void interbyte_timeout(void* context)
 {
   self_t* self = context;
+
+  if(timeout_was_extended(self, self->timing->interbyte_timeout, interbyte_timeout)) {
+    return;
+  }
+
   tiny_fsm_send_signal(&self->fsm, signal_interbyte_timeout, NULL);
 }
 
@@ -517,7 +715,7 @@ static void start_interbyte_timeout_timer(self_t* self)
   tiny_timer_start(
     &self->timer_group,
     &self->timer,
-    gea2_interbyte_timeout_msec,
+    self->timing->interbyte_timeout,
     self,
     interbyte_timeout);
 }
@@ -529,17 +727,19 @@ static void state_receive(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal, const
   switch(signal) {
     case tiny_fsm_signal_entry:
       self->receive.count = 0;
+      record_byte_time(self);
       start_interbyte_timeout_timer(self);
       break;
 
     case signal_byte_received: {
       const uint8_t* byte = data;
-      start_interbyte_timeout_timer(self);
+      record_byte_time(self);
       process_received_byte(self, *byte);
       break;
     }
 
     case signal_interbyte_timeout:
+      raise_interbyte_timeout_diagnostics_event(self);
       tiny_fsm_transition(fsm, state_idle_cooldown);
       break;
   }
@@ -551,9 +751,18 @@ static void idle_cooldown_timeout(void* context)
   tiny_fsm_send_signal(&self->fsm, signal_idle_cooldown_timeout, NULL);
 }
 
-static tiny_timer_ticks_t get_idle_timeout(uint8_t address)
+void tiny_gea2_interface_byte_received(self_t* self, uint8_t byte)
 {
-  return 10 + (address & 0x1F);
+  // Data bytes in the middle of a packet are handled without going through the state machine,
+  // this must stay equivalent to state_receive handling the byte
+  if((self->fsm.current == state_receive) && !needs_escape(byte)) {
+    record_byte_time(self);
+    self->receive.escaped = false;
+    buffer_received_byte(self, byte);
+    return;
+  }
+
+  tiny_fsm_send_signal(&self->fsm, signal_byte_received, &byte);
 }
 
 static void state_idle_cooldown(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal, const void* data)
@@ -566,7 +775,7 @@ static void state_idle_cooldown(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal,
       tiny_timer_start(
         &self->timer_group,
         &self->timer,
-        get_idle_timeout(self->address),
+        get_cooldown(self, tiny_gea2_interface_cooldown_idle),
         self,
         idle_cooldown_timeout);
       break;
@@ -592,14 +801,82 @@ static void state_idle_cooldown(tiny_fsm_t* fsm, const tiny_fsm_signal_t signal,
   }
 }
 
+static tiny_queue_t* next_send_queue(self_t* self)
+{
+  if(self->send.priority_commands && (tiny_queue_count(&self->send.priority_queue) > 0)) {
+    return &self->send.priority_queue;
+  }
+
+  return &self->send.queue;
+}
+
+static uint8_t queued_destination(tiny_queue_t* queue, uint16_t index)
+{
+  uint8_t destination;
+  tiny_queue_peek_partial(queue, &destination, sizeof(destination), offsetof(tiny_gea_packet_t, destination), index);
+  return destination;
+}
+
+static bool find_packet(tiny_queue_t* queue, uint8_t destination, bool matching, uint16_t* index)
+{
+  uint16_t count = tiny_queue_count(queue);
+
+  for(uint16_t i = 0; i < count; i++) {
+    if((queued_destination(queue, i) == destination) == matching) {
+      *index = i;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void select_packet_to_send(self_t* self)
+{
+  tiny_queue_t* queue = self->send.active_queue;
+  uint16_t index;
+
+  self->send.index = 0;
+  self->send.retries = self->retries;
+  self->send.can_rotate = false;
+
+  if(self->send.backoff.active && (queue == &self->send.queue)) {
+    if(!self->send.backoff.other_destination_sent && find_packet(queue, self->send.backoff.destination, false, &index)) {
+      self->send.index = index;
+      self->send.backoff.other_destination_sent = true;
+      return;
+    }
+
+    self->send.backoff.active = false;
+
+    if(find_packet(queue, self->send.backoff.destination, true, &index)) {
+      self->send.index = index;
+      self->send.retries = self->send.backoff.retries;
+    }
+  }
+
+  if(self->send.rotate_destinations && (queue == &self->send.queue) && !self->send.backoff.active) {
+    self->send.can_rotate = find_packet(queue, queued_destination(queue, self->send.index), false, &index);
+  }
+}
+
+static bool can_rotate_to(self_t* self, uint8_t destination)
+{
+  return self->send.rotate_destinations &&
+    (self->send.active_queue == &self->send.queue) &&
+    !self->send.backoff.active &&
+    (destination != queued_destination(self->send.active_queue, self->send.index));
+}
+
 static void begin_send(self_t* self)
 {
-  tiny_queue_peek_partial(&self->send.queue, &self->send.data_length, sizeof(self->send.data_length), offsetof(tiny_gea_packet_t, payload_length), 0);
+  self->send.active_queue = next_send_queue(self);
+  select_packet_to_send(self);
+  tiny_queue_peek_partial(self->send.active_queue, &self->send.data_length, sizeof(self->send.data_length), offsetof(tiny_gea_packet_t, payload_length), self->send.index);
   self->send.state = send_state_destination;
   self->send.offset = 0;
   self->send.in_progress = true;
   self->send.packet_queued_in_background = true;
-  self->send.retries = self->retries;
 }
 
 typedef struct {
@@ -612,6 +889,19 @@ typedef struct {
   bool queued;
 } send_worker_context_t;
 
+static tiny_queue_t* send_queue_for_packet(self_t* self, const tiny_gea_packet_t* packet, uint8_t payload_length)
+{
+  if(self->send.priority_commands && (payload_length > 0)) {
+    uint8_t command = packet->payload[0];
+
+    if(self->send.priority_commands[command / 8] & (1 << (command % 8))) {
+      return &self->send.priority_queue;
+    }
+  }
+
+  return &self->send.queue;
+}
+
 static void send_worker_callback(void* _context, void* buffer)
 {
   send_worker_context_t* context = _context;
@@ -624,7 +914,10 @@ static void send_worker_callback(void* _context, void* buffer)
   }
   packet->destination = context->destination;
 
-  context->queued = tiny_queue_enqueue(&context->self->send.queue, buffer, tiny_gea_packet_overhead + context->payload_length);
+  context->queued = tiny_queue_enqueue(
+    send_queue_for_packet(context->self, packet, context->payload_length),
+    buffer,
+    tiny_gea_packet_overhead + context->payload_length);
 }
 
 static bool send_worker(
@@ -658,21 +951,38 @@ static bool send_worker(
   if(!self->send.in_progress) {
     begin_send(self);
   }
+  else if(can_rotate_to(self, destination)) {
+    self->send.can_rotate = true;
+  }
 
   return true;
 }
 
-static void msec_interrupt_callback(void* context, const void* _args)
+tiny_timer_ticks_t tiny_gea2_interface_service(self_t* self)
 {
-  self_t* self = context;
-  (void)_args;
-
   if(self->send.packet_queued_in_background) {
     self->send.packet_queued_in_background = false;
     tiny_fsm_send_signal(&self->fsm, signal_send_ready, NULL);
   }
 
-  tiny_timer_group_run(&self->timer_group);
+  return tiny_timer_group_run(&self->timer_group);
+}
+
+tiny_timer_ticks_t tiny_gea2_interface_ticks_until_next_deadline(self_t* self)
+{
+  if(self->send.packet_queued_in_background) {
+    return 0;
+  }
+
+  return tiny_timer_group_ticks_until_next_ready(&self->timer_group);
+}
+
+static void msec_interrupt_callback(void* context, const void* _args)
+{
+  self_t* self = context;
+  (void)_args;
+
+  tiny_gea2_interface_service(self);
 }
 
 static bool send(
@@ -720,24 +1030,41 @@ void tiny_gea2_interface_init(
   self->uart = uart;
   self->address = address;
   self->ignore_destination_address = ignore_destination_address;
+  self->address_filter = NULL;
+  self->diagnostics_enabled = false;
+  self->timing = &default_timing;
+  self->cooldown_policy = NULL;
+  self->transmit_gate = NULL;
+  self->send.window = 1;
+  self->send.index = 0;
+  self->send.rotate_destinations = false;
+  self->send.can_rotate = false;
+  self->send.deferred = false;
+  self->send.backoff.active = false;
   self->receive.buffer = receive_buffer;
   self->receive.buffer_size = receive_buffer_size;
   self->receive.packet_ready = false;
   self->receive.escaped = false;
+  self->receive.dropping = false;
   self->send.in_progress = false;
   self->send.completed = false;
   self->send.packet_queued_in_background = false;
   self->retries = retries;
 
   tiny_queue_init(&self->send.queue, send_queue_buffer, send_queue_buffer_size);
+  self->send.active_queue = &self->send.queue;
+  self->send.priority_commands = NULL;
 
   tiny_timer_group_init(&self->timer_group, time_source);
+  self->last_byte_time = 0;
 
   tiny_event_subscription_init(&self->byte_received_subscription, self, byte_received);
   tiny_event_subscribe(tiny_uart_on_receive(uart), &self->byte_received_subscription);
 
-  tiny_event_subscription_init(&self->msec_interrupt_subscription, self, msec_interrupt_callback);
-  tiny_event_subscribe(msec_interrupt, &self->msec_interrupt_subscription);
+  if(msec_interrupt) {
+    tiny_event_subscription_init(&self->msec_interrupt_subscription, self, msec_interrupt_callback);
+    tiny_event_subscribe(msec_interrupt, &self->msec_interrupt_subscription);
+  }
 
   tiny_event_init(&self->on_receive);
   tiny_event_init(&self->on_diagnostics_event);
@@ -756,14 +1083,144 @@ void tiny_gea2_interface_run(self_t* self)
   }
 
   if(self->send.completed) {
-    tiny_queue_discard(&self->send.queue);
+    if(self->send.deferred) {
+      self->send.deferred = false;
+      self->send.backoff.active = true;
+      self->send.backoff.other_destination_sent = false;
+      self->send.backoff.destination = queued_destination(self->send.active_queue, self->send.index);
+      self->send.backoff.retries = self->send.retries;
+    }
+    else {
+      tiny_queue_remove(self->send.active_queue, self->send.index);
+    }
+
     self->send.in_progress = false;
     self->send.completed = false;
   }
 
   if(!self->send.in_progress) {
-    if(tiny_queue_count(&self->send.queue) > 0) {
+    if(tiny_queue_count(next_send_queue(self)) > 0) {
       begin_send(self);
     }
   }
 }
+
+void tiny_gea2_interface_set_address_filter(
+  tiny_gea2_interface_t* self,
+  const uint8_t* address_filter)
+{
+  self->address_filter = address_filter;
+}
+
+void tiny_gea2_interface_use_priority_send_queue(
+  tiny_gea2_interface_t* self,
+  uint8_t* priority_send_queue_buffer,
+  size_t priority_send_queue_buffer_size,
+  const uint8_t* priority_commands)
+{
+  tiny_queue_init(&self->send.priority_queue, priority_send_queue_buffer, priority_send_queue_buffer_size);
+  self->send.priority_commands = priority_commands;
+}
+
+static tiny_timer_ticks_t scaled_ticks(uint32_t reference_msec, uint32_t baud, uint32_t ticks_per_second)
+{
+  uint64_t numerator = (uint64_t)reference_msec * gea2_reference_baud * ticks_per_second;
+  uint64_t denominator = (uint64_t)baud * 1000;
+  uint64_t ticks = (numerator + denominator - 1) / denominator;
+
+  return (ticks == 0) ? 1 : (tiny_timer_ticks_t)ticks;
+}
+
+void tiny_gea2_interface_timing_init(
+  tiny_gea2_interface_timing_t* timing,
+  uint32_t baud,
+  uint32_t ticks_per_second)
+{
+  timing->reflection_timeout = scaled_ticks(gea2_reflection_timeout_msec, baud, ticks_per_second);
+  timing->ack_timeout = scaled_ticks(gea2_ack_timeout_msec, baud, ticks_per_second);
+  timing->interbyte_timeout = scaled_ticks(gea2_interbyte_timeout_msec, baud, ticks_per_second);
+  timing->idle_cooldown_base = scaled_ticks(gea2_idle_cooldown_base_msec, baud, ticks_per_second);
+  timing->collision_cooldown_base = scaled_ticks(gea2_collision_cooldown_base_msec, baud, ticks_per_second);
+  timing->cooldown_step = scaled_ticks(gea2_cooldown_step_msec, baud, ticks_per_second);
+}
+
+void tiny_gea2_interface_set_timing(
+  tiny_gea2_interface_t* self,
+  const tiny_gea2_interface_timing_t* timing)
+{
+  self->timing = timing;
+}
+
+tiny_timer_ticks_t tiny_gea2_interface_default_cooldown_policy(
+  void* context,
+  const tiny_gea2_interface_cooldown_args_t* args)
+{
+  reinterpret(time_source, context, i_tiny_time_source_t*);
+  const tiny_gea2_interface_timing_t* timing = args->timing;
+  uint8_t address_steps = args->address & 0x1F;
+
+  if(args->cooldown == tiny_gea2_interface_cooldown_idle) {
+    return timing->idle_cooldown_base + address_steps * timing->cooldown_step;
+  }
+
+  // The low byte of the time source is used as a pseudo-random number
+  uint8_t pseudo_random_number = (uint8_t)tiny_time_source_ticks(time_source);
+  uint8_t random_steps = (pseudo_random_number ^ args->address) & 0x1F;
+
+  return timing->collision_cooldown_base + (address_steps + random_steps) * timing->cooldown_step;
+}
+
+void tiny_gea2_interface_set_cooldown_policy(
+  tiny_gea2_interface_t* self,
+  void* context,
+  tiny_gea2_interface_cooldown_policy_t policy)
+{
+  self->cooldown_policy_context = context;
+  self->cooldown_policy = policy;
+}
+
+void tiny_gea2_interface_set_transmit_gate(
+  tiny_gea2_interface_t* self,
+  void* context,
+  tiny_gea2_interface_transmit_gate_t gate)
+{
+  self->transmit_gate_context = context;
+  self->transmit_gate = gate;
+}
+
+void tiny_gea2_interface_set_send_window(
+  tiny_gea2_interface_t* self,
+  uint8_t window)
+{
+  if(window < 1) {
+    window = 1;
+  }
+
+  if(window > tiny_gea2_interface_max_send_window) {
+    window = tiny_gea2_interface_max_send_window;
+  }
+
+  self->send.window = window;
+}
+
+void tiny_gea2_interface_enable_diagnostics(tiny_gea2_interface_t* self)
+{
+  self->diagnostics_enabled = true;
+}
+
+i_tiny_event_t* tiny_gea2_interface_on_diagnostics_event(tiny_gea2_interface_t* self)
+{
+  return &self->on_diagnostics_event.interface;
+}
+
+void tiny_gea2_interface_rotate_destinations_after_failures(
+  tiny_gea2_interface_t* self,
+  bool enabled)
+{
+  self->send.rotate_destinations = enabled;
+}
+
+void tiny_gea2_interface_use_direct_byte_receive(tiny_gea2_interface_t* self)
+{
+  tiny_event_unsubscribe(tiny_uart_on_receive(self->uart), &self->byte_received_subscription);
+}
@@ -0,0 +1,183 @@
+/*!
+ * @file
+ * @brief
+ */
+
+#include "tiny_gea2_tdma.h"
+#include "tiny_utils.h"
+
+typedef tiny_gea2_tdma_t self_t;
+
+static tiny_time_source_ticks_t ticks_since_sync(self_t* self)
+{
+  return (tiny_time_source_ticks_t)(tiny_time_source_ticks(self->time_source) - self->sync_time);
+}
+
+static uint32_t frame_position(self_t* self, tiny_time_source_ticks_t ticks)
+{
+  uint32_t frame_ticks = (uint32_t)self->config->slot_count * self->config->slot_ticks;
+  return (tiny_time_source_ticks_t)(ticks - self->frame_start) % frame_ticks;
+}
+
+static bool config_is_valid(const tiny_gea2_tdma_config_t* config)
+{
+  return (config->slot_count > 0) && (config->slot_ticks > 0);
+}
+
+static bool owns_a_slot(self_t* self)
+{
+  if(!self->config_valid) {
+    return false;
+  }
+
+  for(uint8_t i = 0; i < self->config->slot_count; i++) {
+    if(self->config->slot_owners[i] == self->address) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static bool synchronized(self_t* self)
+{
+  if(self->synchronized && (ticks_since_sync(self) >= self->config->sync_timeout)) {
+    self->synchronized = false;
+  }
+
+  return self->synchronized;
+}
+
+static tiny_timer_ticks_t ticks_until_own_slot(self_t* self)
+{
+  const tiny_gea2_tdma_config_t* config = self->config;
+  uint32_t position = frame_position(self, tiny_time_source_ticks(self->time_source));
+  uint8_t current_slot = (uint8_t)(position / config->slot_ticks);
+  tiny_timer_ticks_t ticks_into_slot = (tiny_timer_ticks_t)(position % config->slot_ticks);
+
+  // Checking one slot past a full frame covers being too late in the only owned slot
+  for(uint16_t i = 0; i <= config->slot_count; i++) {
+    uint8_t slot = (uint8_t)((current_slot + i) % config->slot_count);
+
+    if(config->slot_owners[slot] != self->address) {
+      continue;
+    }
+
+    if(i > 0) {
+      return i * config->slot_ticks - ticks_into_slot;
+    }
+
+    if((config->slot_ticks - ticks_into_slot) >= config->guard_ticks) {
+      return 0;
+    }
+  }
+
+  return 0;
+}
+
+static tiny_timer_ticks_t transmit_gate(void* context)
+{
+  reinterpret(self, context, self_t*);
+
+  if(!synchronized(self) || !owns_a_slot(self)) {
+    return 0;
+  }
+
+  return ticks_until_own_slot(self);
+}
+
+static tiny_timer_ticks_t cooldown(void* context, const tiny_gea2_interface_cooldown_args_t* args)
+{
+  reinterpret(self, context, self_t*);
+
+  // Slots keep nodes apart so the bus only needs to settle before the gate is checked
+  if(synchronized(self) && owns_a_slot(self)) {
+    return args->timing->idle_cooldown_base;
+  }
+
+  if(self->fallback) {
+    return self->fallback(self->fallback_context, args);
+  }
+
+  return tiny_gea2_interface_default_cooldown_policy(self->time_source, args);
+}
+
+// The frame is anchored so that the slot after the sync node's slot starts when the sync broadcast
+// ends. If the broadcast ended in one of the sync node's slots that slot is cut short, otherwise the
+// frame restarts after the sync node's first slot. Either way a resync never hands the bus back to
+// the sync node so a sync node with a backlog cannot starve the other nodes.
+static uint8_t slot_after_sync(self_t* self, tiny_time_source_ticks_t timestamp)
+{
+  const tiny_gea2_tdma_config_t* config = self->config;
+
+  if(synchronized(self)) {
+    uint8_t current_slot = (uint8_t)(frame_position(self, timestamp) / config->slot_ticks);
+
+    if(config->slot_owners[current_slot] == config->sync_address) {
+      return (uint8_t)(current_slot + 1);
+    }
+  }
+
+  for(uint8_t i = 0; i < config->slot_count; i++) {
+    if(config->slot_owners[i] == config->sync_address) {
+      return (uint8_t)(i + 1);
+    }
+  }
+
+  return 0;
+}
+
+static void diagnostics_event_raised(void* context, const void* _args)
+{
+  reinterpret(self, context, self_t*);
+  reinterpret(args, _args, const tiny_gea2_interface_diagnostics_event_args_t*);
+
+  if(!args->broadcast || !self->config_valid) {
+    return;
+  }
+
+  bool received_from_sync_node =
+    (args->type == tiny_gea2_interface_diagnostics_event_packet_received) &&
+    (args->address == self->config->sync_address);
+  bool sent_by_sync_node =
+    (args->type == tiny_gea2_interface_diagnostics_event_packet_sent) &&
+    (self->address == self->config->sync_address);
+
+  if(received_from_sync_node || sent_by_sync_node) {
+    uint8_t slot = slot_after_sync(self, args->timestamp);
+    self->frame_start = (tiny_time_source_ticks_t)(args->timestamp - slot * self->config->slot_ticks);
+    self->sync_time = args->timestamp;
+    self->synchronized = true;
+  }
+}
+
+void tiny_gea2_tdma_init(
+  tiny_gea2_tdma_t* self,
+  tiny_gea2_interface_t* gea2_interface,
+  i_tiny_time_source_t* time_source,
+  const tiny_gea2_tdma_config_t* config,
+  void* fallback_context,
+  tiny_gea2_interface_cooldown_policy_t fallback)
+{
+  self->time_source = time_source;
+  self->config = config;
+  self->fallback_context = fallback_context;
+  self->fallback = fallback;
+  self->address = gea2_interface->address;
+  self->sync_time = 0;
+  self->frame_start = 0;
+  self->synchronized = false;
+  self->config_valid = config_is_valid(config);
+
+  tiny_gea2_interface_set_transmit_gate(gea2_interface, self, transmit_gate);
+  tiny_gea2_interface_set_cooldown_policy(gea2_interface, self, cooldown);
+
+  tiny_event_subscription_init(&self->diagnostics_event, self, diagnostics_event_raised);
+  tiny_event_subscribe(tiny_gea2_interface_on_diagnostics_event(gea2_interface), &self->diagnostics_event);
+  tiny_gea2_interface_enable_diagnostics(gea2_interface);
+}
+
+bool tiny_gea2_tdma_synchronized(tiny_gea2_tdma_t* self)
+{
+  return synchronized(self);
+}
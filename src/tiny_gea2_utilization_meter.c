@@ -0,0 +1,153 @@
+/*!
+ * @file
+ * @brief
+ */
+
+#include <string.h>
+#include "tiny_gea2_utilization_meter.h"
+#include "tiny_gea_constants.h"
+#include "tiny_utils.h"
+
+enum {
+  bits_per_byte = 10 // Start bit, 8 data bits, stop bit
+};
+
+typedef tiny_gea2_utilization_meter_t self_t;
+
+static tiny_gea2_utilization_meter_counters_t* current_counters(self_t* self)
+{
+  return &self->counters[self->current];
+}
+
+static void byte_received(void* context, const void* _args)
+{
+  reinterpret(self, context, self_t*);
+  reinterpret(args, _args, const tiny_uart_on_receive_args_t*);
+  tiny_gea2_utilization_meter_counters_t* counters = current_counters(self);
+
+  counters->bytes++;
+
+  if(args->byte == tiny_gea_stx) {
+    counters->packets++;
+  }
+}
+
+static void byte_sent(void* context, const void* args)
+{
+  reinterpret(self, context, self_t*);
+  (void)args;
+
+  current_counters(self)->sent_bytes++;
+}
+
+static void diagnostics_event_raised(void* context, const void* _args)
+{
+  reinterpret(self, context, self_t*);
+  reinterpret(args, _args, const tiny_gea2_interface_diagnostics_event_args_t*);
+  tiny_gea2_utilization_meter_counters_t* counters = current_counters(self);
+
+  switch(args->type) {
+    case tiny_gea2_interface_diagnostics_event_packet_sent:
+      counters->packets_sent++;
+      break;
+
+    case tiny_gea2_interface_diagnostics_event_collision:
+      counters->collisions++;
+      counters->failed_attempts++;
+      break;
+
+    case tiny_gea2_interface_diagnostics_event_reflection_timeout:
+    case tiny_gea2_interface_diagnostics_event_ack_timeout:
+      counters->failed_attempts++;
+      break;
+  }
+}
+
+static uint32_t ratio(uint64_t numerator, uint64_t denominator, uint32_t scale)
+{
+  if(denominator == 0) {
+    return 0;
+  }
+
+  uint64_t result = numerator * scale / denominator;
+  return (result > UINT32_MAX) ? UINT32_MAX : (uint32_t)result;
+}
+
+static uint16_t ratio_u16(uint64_t numerator, uint64_t denominator, uint32_t scale)
+{
+  uint32_t result = ratio(numerator, denominator, scale);
+  return (result > UINT16_MAX) ? UINT16_MAX : (uint16_t)result;
+}
+
+static uint16_t permille(uint64_t numerator, uint64_t denominator)
+{
+  uint32_t result = ratio(numerator, denominator, 1000);
+  return (result > 1000) ? 1000 : (uint16_t)result;
+}
+
+static void measure(self_t* self, const tiny_gea2_utilization_meter_counters_t* counters, tiny_time_source_ticks_t elapsed)
+{
+  tiny_gea2_utilization_t* utilization = &self->utilization;
+  uint32_t attempts = counters->packets_sent + counters->failed_attempts;
+
+  utilization->busy_permille = permille(
+    (uint64_t)counters->bytes * bits_per_byte * self->ticks_per_second,
+    (uint64_t)self->baud * elapsed);
+  utilization->transmit_share_permille = permille(counters->sent_bytes, counters->bytes);
+  utilization->bytes_per_second = ratio(counters->bytes, elapsed, self->ticks_per_second);
+  utilization->packets_per_second = ratio_u16(counters->packets, elapsed, self->ticks_per_second);
+  utilization->retries_per_packet_x100 = ratio_u16(counters->failed_attempts, counters->packets_sent, 100);
+  utilization->collision_permille = permille(counters->collisions, attempts);
+}
+
+void tiny_gea2_utilization_meter_init(
+  tiny_gea2_utilization_meter_t* self,
+  tiny_gea2_interface_t* gea2_interface,
+  i_tiny_uart_t* uart,
+  i_tiny_time_source_t* time_source,
+  uint32_t baud,
+  uint32_t ticks_per_second,
+  tiny_time_source_ticks_t window_ticks)
+{
+  self->time_source = time_source;
+  self->baud = baud;
+  self->ticks_per_second = ticks_per_second;
+  self->window_ticks = window_ticks;
+  self->window_start = tiny_time_source_ticks(time_source);
+  self->current = 0;
+
+  memset(self->counters, 0, sizeof(self->counters));
+  memset(&self->utilization, 0, sizeof(self->utilization));
+
+  tiny_event_subscription_init(&self->byte_received, self, byte_received);
+  tiny_event_subscribe(tiny_uart_on_receive(uart), &self->byte_received);
+
+  tiny_event_subscription_init(&self->byte_sent, self, byte_sent);
+  tiny_event_subscribe(tiny_uart_on_send_complete(uart), &self->byte_sent);
+
+  tiny_event_subscription_init(&self->diagnostics_event, self, diagnostics_event_raised);
+  tiny_event_subscribe(tiny_gea2_interface_on_diagnostics_event(gea2_interface), &self->diagnostics_event);
+  tiny_gea2_interface_enable_diagnostics(gea2_interface);
+}
+
+void tiny_gea2_utilization_meter_run(tiny_gea2_utilization_meter_t* self)
+{
+  tiny_time_source_ticks_t now = tiny_time_source_ticks(self->time_source);
+  tiny_time_source_ticks_t elapsed = (tiny_time_source_ticks_t)(now - self->window_start);
+
+  if(elapsed < self->window_ticks) {
+    return;
+  }
+
+  uint8_t completed = self->current;
+  self->current = !completed;
+  self->window_start = now;
+
+  measure(self, &self->counters[completed], elapsed);
+  memset(&self->counters[completed], 0, sizeof(self->counters[completed]));
+}
+
+const tiny_gea2_utilization_t* tiny_gea2_utilization_meter_utilization(tiny_gea2_utilization_meter_t* self)
+{
+  return &self->utilization;
+}
@@ -8,6 +8,7 @@
 #include "tiny_gea3_erd_api.h"
 #include "tiny_gea3_erd_client.h"
 #include "tiny_gea_constants.h"
+#include "tiny_gea_erd_view.h"
 #include "tiny_stack_allocator.h"
 #include "tiny_utils.h"
 
@@ -15,24 +16,55 @@ enum {
   request_type_read,
   request_type_write,
   request_type_subscribe,
+  request_type_gather_read,
+  request_type_unacknowledged_write,
+  request_type_read_batch,
+  request_type_write_batch,
   request_type_invalid
 };
 typedef uint8_t request_type_t;
 
+enum {
+  // Only this many requests at the front of the queue are considered for being sent early so that
+  // choosing the next request does not take longer as the queue grows
+  early_send_window = 8
+};
+
+// Every request starts with its request ID, the time it was queued, its deadline and its priority
+// followed by its type and address. The request ID and queue time are not considered when
+// detecting duplicates so that a duplicate can report the ID of the request that is already queued.
+// The deadline and priority are so that a request is never merged into one with different options.
+
 typedef struct {
+  tiny_gea3_erd_client_request_id_t request_id;
+  tiny_time_source_ticks_t queued_ticks;
+  tiny_time_source_ticks_t deadline;
+  uint8_t priority;
   request_type_t type;
+  uint8_t address;
 } request_t;
 
 // These request types need to have no padding _or_ we need to memset them to 0
 // since we memcmp the requests to detect duplicates
 
+// Gather reads use the read request layout with the request_type_gather_read type and the
+// broadcast address
+
 typedef struct {
+  tiny_gea3_erd_client_request_id_t request_id;
+  tiny_time_source_ticks_t queued_ticks;
+  tiny_time_source_ticks_t deadline;
+  uint8_t priority;
   request_type_t type;
   uint8_t address;
   tiny_erd_t erd;
 } read_request_t;
 
 typedef struct {
+  tiny_gea3_erd_client_request_id_t request_id;
+  tiny_time_source_ticks_t queued_ticks;
+  tiny_time_source_ticks_t deadline;
+  uint8_t priority;
   request_type_t type;
   uint8_t address;
   tiny_erd_t erd;
@@ -40,12 +72,32 @@ typedef struct {
   uint8_t data[1];
 } write_request_t;
 
+// Unacknowledged writes are stored as write requests
+
 typedef struct {
+  tiny_gea3_erd_client_request_id_t request_id;
+  tiny_time_source_ticks_t queued_ticks;
+  tiny_time_source_ticks_t deadline;
+  uint8_t priority;
   request_type_t type;
   uint8_t address;
   bool retain;
 } subscribe_request_t;
 
+// Batches point to caller-owned items. The status of the items is used to track which item is in
+// flight so that nothing in the queue needs to be updated as the batch progresses.
+
+typedef struct {
+  tiny_gea3_erd_client_request_id_t request_id;
+  tiny_time_source_ticks_t queued_ticks;
+  tiny_time_source_ticks_t deadline;
+  uint8_t priority;
+  request_type_t type;
+  uint8_t address;
+  uint8_t item_count;
+  tiny_gea3_erd_client_batch_item_t* items;
+} batch_request_t;
+
 typedef bool (*requests_conflict_predicate_t)(const request_t* new_request, const request_t* queued_request);
 
 typedef tiny_gea3_erd_client_t self_t;
@@ -121,32 +173,26 @@ static bool valid_subscribe_all_response(const tiny_gea_packet_t* packet)
   return true;
 }
 
+// Publications are walked twice: once here to check every record and again to dispatch them. A
+// malformed publication is not acknowledged and will be sent again so dispatching while checking
+// would publish its leading records twice. Walking only hops from record header to record header so
+// correctness is traded for a second, cheap pass rather than parsing each publication once.
 static bool valid_subscription_publication(const tiny_gea_packet_t* packet)
 {
-  if(packet->payload_length < 4) {
+  if(packet->payload_length < sizeof(tiny_gea3_erd_api_publication_header_t)) {
     return false;
   }
 
-  const uint8_t claimed_count = packet->payload[3];
-  uint8_t actual_count = 0;
-  uint8_t index = 4;
-
-  while(index < packet->payload_length) {
-    index += sizeof(tiny_erd_t);
-
-    if(index >= packet->payload_length) {
-      return false;
-    }
+  reinterpret(payload, packet->payload, const tiny_gea3_erd_api_publication_header_t*);
 
-    uint8_t size = packet->payload[index++];
-    index += size;
+  tiny_gea_erd_view_t view;
+  tiny_gea_erd_view_init_from_packet(&view, packet, sizeof(*payload), payload->erd_count);
 
-    if(index <= packet->payload_length) {
-      actual_count++;
-    }
+  tiny_gea_erd_view_entry_t entry;
+  while(tiny_gea_erd_view_next(&view, &entry)) {
   }
 
-  return actual_count == claimed_count;
+  return tiny_gea_erd_view_complete(&view);
 }
 
 static bool valid_subscription_publication_acknowledgment(const tiny_gea_packet_t* packet)
@@ -215,7 +261,7 @@ static void send_read_request(self_t* self)
   read_request_t request;
   uint16_t size;
 
-  tiny_queue_peek(&self->request_queue, &request, &size, 0);
+  tiny_queue_peek(&self->request_queue, &request, &size, self->active_index);
 
   read_request_worker_context_t context = { self, &request };
 
@@ -232,25 +278,25 @@ static void send_write_request_worker(void* _context, tiny_gea_packet_t* packet)
   reinterpret(self, _context, self_t*);
 
   write_request_t request;
-  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
+  tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, self->active_index);
 
-  uint16_t size;
-  tiny_queue_peek(&self->request_queue, (uint8_t*)packet + 3, &size, 0);
+  reinterpret(payload, packet->payload, tiny_gea3_erd_api_write_request_payload_t*);
+  tiny_queue_peek_partial(&self->request_queue, payload->data, request.data_size, offsetof(write_request_t, data), self->active_index);
 
   packet->destination = request.address;
-  packet->payload[0] = tiny_gea3_erd_api_command_write_request;
-  packet->payload[1] = self->request_id;
-  packet->payload[2] = request.erd >> 8;
-  packet->payload[3] = request.erd & 0xFF;
-  packet->payload[4] = request.data_size;
+  payload->header.command = tiny_gea3_erd_api_command_write_request;
+  payload->header.request_id = self->request_id;
+  payload->header.erd_msb = request.erd >> 8;
+  payload->header.erd_lsb = request.erd & 0xFF;
+  payload->header.data_size = request.data_size;
 }
 
-static void send_write_request(self_t* self)
+static bool send_write_request(self_t* self)
 {
   write_request_t request;
-  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
+  tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, self->active_index);
 
-  tiny_gea_interface_send(
+  return tiny_gea_interface_send(
     self->gea3_interface,
     request.address,
     sizeof(tiny_gea3_erd_api_write_request_payload_header_t) + request.data_size,
@@ -280,7 +326,7 @@ static void send_subscribe_request(self_t* self)
   subscribe_request_t request;
   uint16_t size;
 
-  tiny_queue_peek(&self->request_queue, &request, &size, 0);
+  tiny_queue_peek(&self->request_queue, &request, &size, self->active_index);
 
   subscribe_request_worker_context_t context = { self, &request };
 
@@ -292,6 +338,69 @@ static void send_subscribe_request(self_t* self)
     send_subscribe_request_worker);
 }
 
+static tiny_gea3_erd_client_batch_item_t* current_batch_item(self_t* self)
+{
+  batch_request_t request;
+  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
+
+  for(uint8_t i = 0; i < request.item_count; i++) {
+    if(request.items[i].status == tiny_gea3_erd_client_batch_item_status_pending) {
+      return &request.items[i];
+    }
+  }
+
+  return NULL;
+}
+
+typedef struct {
+  self_t* self;
+  const tiny_gea3_erd_client_batch_item_t* item;
+} batch_write_request_worker_context_t;
+
+static void send_batch_write_request_worker(void* _context, tiny_gea_packet_t* packet)
+{
+  batch_write_request_worker_context_t* context = _context;
+  const tiny_gea3_erd_client_batch_item_t* item = context->item;
+  reinterpret(payload, packet->payload, tiny_gea3_erd_api_write_request_payload_t*);
+
+  payload->header.command = tiny_gea3_erd_api_command_write_request;
+  payload->header.request_id = context->self->request_id;
+  payload->header.erd_msb = item->erd >> 8;
+  payload->header.erd_lsb = item->erd & 0xFF;
+  payload->header.data_size = item->data_size;
+  memcpy(payload->data, item->data, item->data_size);
+}
+
+static void send_batch_request(self_t* self, request_type_t type)
+{
+  const tiny_gea3_erd_client_batch_item_t* item = current_batch_item(self);
+
+  if(type == request_type_read_batch) {
+    read_request_t request;
+    request.address = item->address;
+    request.erd = item->erd;
+
+    read_request_worker_context_t context = { self, &request };
+
+    tiny_gea_interface_send(
+      self->gea3_interface,
+      item->address,
+      sizeof(tiny_gea3_erd_api_read_request_payload_t),
+      &context,
+      send_read_request_worker);
+  }
+  else {
+    batch_write_request_worker_context_t context = { self, item };
+
+    tiny_gea_interface_send(
+      self->gea3_interface,
+      item->address,
+      sizeof(tiny_gea3_erd_api_write_request_payload_header_t) + item->data_size,
+      &context,
+      send_batch_write_request_worker);
+  }
+}
+
 static void resend_request(self_t* self);
 
 static void request_timed_out(void* context)
@@ -310,6 +419,27 @@ static void arm_request_timeout(self_t* self)
     request_timed_out);
 }
 
+static void complete_gather_read(self_t* self);
+
+static void gather_window_elapsed(void* context)
+{
+  reinterpret(self, context, self_t*);
+  complete_gather_read(self);
+}
+
+static void arm_gather_window(self_t* self)
+{
+  memset(self->gather_responders, 0, sizeof(self->gather_responders));
+  self->gather_responder_count = 0;
+
+  tiny_timer_start(
+    self->timer_group,
+    &self->request_retry_timer,
+    self->configuration->gather_window,
+    self,
+    gather_window_elapsed);
+}
+
 static void disarm_request_timeout(self_t* self)
 {
   tiny_timer_stop(
@@ -326,7 +456,7 @@ static request_type_t request_type(self_t* self)
 {
   if(request_pending(self)) {
     request_t request;
-    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
+    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
     return request.type;
   }
   else {
@@ -334,40 +464,265 @@ static request_type_t request_type(self_t* self)
   }
 }
 
+static void complete_unacknowledged_write(self_t* self);
+
 static void send_request(self_t* self)
 {
   switch(request_type(self)) {
     case request_type_read:
       send_read_request(self);
+      arm_request_timeout(self);
       break;
 
     case request_type_write:
       send_write_request(self);
+      arm_request_timeout(self);
       break;
 
     case request_type_subscribe:
       send_subscribe_request(self);
+      arm_request_timeout(self);
       break;
+
+    case request_type_gather_read:
+      send_read_request(self);
+      arm_gather_window(self);
+      break;
+
+    case request_type_unacknowledged_write:
+      // If the interface cannot accept the packet right now then it is retried like any other request
+      if(send_write_request(self)) {
+        complete_unacknowledged_write(self);
+      }
+      else {
+        arm_request_timeout(self);
+      }
+      break;
+
+    case request_type_read_batch:
+    case request_type_write_batch:
+      send_batch_request(self, request_type(self));
+      arm_request_timeout(self);
+      break;
+  }
+}
+
+static bool request_expired(self_t* self)
+{
+  request_t request;
+  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
+
+  if(request.deadline == 0) {
+    return false;
+  }
+
+  tiny_time_source_ticks_t elapsed = (tiny_time_source_ticks_t)(tiny_time_source_ticks(self->timer_group->time_source) - request.queued_ticks);
+  return elapsed >= request.deadline;
+}
+
+static void expire_request(self_t* self);
+
+static bool is_read(const request_t* request)
+{
+  return (request->type == request_type_read) || (request->type == request_type_gather_read) || (request->type == request_type_read_batch);
+}
+
+static bool is_write(const request_t* request)
+{
+  return (request->type == request_type_write) || (request->type == request_type_unacknowledged_write) || (request->type == request_type_write_batch);
+}
+
+static bool is_batch(const request_t* request)
+{
+  return (request->type == request_type_read_batch) || (request->type == request_type_write_batch);
+}
+
+static bool is_read_or_write(const request_t* request)
+{
+  return is_read(request) || is_write(request);
+}
+
+static bool requests_must_stay_in_order(self_t* self, uint16_t earlier_index, uint16_t later_index)
+{
+  request_t earlier;
+  request_t later;
+  tiny_queue_peek_partial(&self->request_queue, &earlier, sizeof(earlier), 0, earlier_index);
+  tiny_queue_peek_partial(&self->request_queue, &later, sizeof(later), 0, later_index);
+
+  if(!is_read_or_write(&earlier) || !is_read_or_write(&later)) {
+    return false;
+  }
+
+  if(is_read(&earlier) && is_read(&later)) {
+    return false;
+  }
+
+  // A batch can include any ERD so it stays in order with any request when either of them is a write
+  if(is_batch(&earlier) || is_batch(&later)) {
+    return true;
+  }
+
+  read_request_t earlier_read_or_write;
+  read_request_t later_read_or_write;
+  tiny_queue_peek_partial(&self->request_queue, &earlier_read_or_write, sizeof(earlier_read_or_write), 0, earlier_index);
+  tiny_queue_peek_partial(&self->request_queue, &later_read_or_write, sizeof(later_read_or_write), 0, later_index);
+
+  bool same_address =
+    (earlier_read_or_write.address == later_read_or_write.address) ||
+    (earlier_read_or_write.address == tiny_gea_broadcast_address) ||
+    (later_read_or_write.address == tiny_gea_broadcast_address);
+
+  return same_address && (earlier_read_or_write.erd == later_read_or_write.erd);
+}
+
+static bool can_be_sent_early(self_t* self, uint16_t index)
+{
+  for(uint16_t i = 0; i < index; i++) {
+    if(requests_must_stay_in_order(self, i, index)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static uint16_t requests_considered_for_sending_early(self_t* self)
+{
+  uint16_t count = tiny_queue_count(&self->request_queue);
+  return (count > early_send_window) ? (uint16_t)early_send_window : count;
+}
+
+static uint16_t highest_priority_request_index(self_t* self)
+{
+  uint16_t count = requests_considered_for_sending_early(self);
+  uint16_t selected_index = 0;
+  request_t selected;
+  tiny_queue_peek_partial(&self->request_queue, &selected, sizeof(selected), 0, 0);
+
+  for(uint16_t i = 1; i < count; i++) {
+    request_t candidate;
+    tiny_queue_peek_partial(&self->request_queue, &candidate, sizeof(candidate), 0, i);
+
+    if((candidate.priority > selected.priority) && can_be_sent_early(self, i)) {
+      selected_index = i;
+      selected = candidate;
+    }
   }
 
-  arm_request_timeout(self);
+  return selected_index;
 }
 
+static void prefer_request_to_last_address(self_t* self, uint8_t priority, uint16_t* index)
+{
+  uint8_t run_limit = self->configuration->address_run_limit;
+
+  if((run_limit == 0) || (self->address_run_count >= run_limit)) {
+    return;
+  }
+
+  uint16_t count = requests_considered_for_sending_early(self);
+
+  for(uint16_t i = 0; i < count; i++) {
+    request_t candidate;
+    tiny_queue_peek_partial(&self->request_queue, &candidate, sizeof(candidate), 0, i);
+
+    if((candidate.address == self->last_address) && (candidate.priority == priority) && can_be_sent_early(self, i)) {
+      *index = i;
+      return;
+    }
+  }
+}
+
+// Selects the oldest request with the highest priority, among the first early_send_window
+// requests, that would not be sent ahead of an older write to, or read of, the same ERD. If
+// enabled, a request of the same priority to the address that was just served is preferred for
+// up to address_run_limit requests in a row. After priority_burst_limit requests have been sent
+// ahead of the oldest request it is sent next so that it cannot be starved.
+static uint16_t next_request_index(self_t* self)
+{
+  uint8_t burst_limit = self->configuration->priority_burst_limit;
+  uint16_t selected_index = 0;
+  request_t selected;
+
+  if((burst_limit == 0) || (self->priority_burst_count < burst_limit)) {
+    selected_index = highest_priority_request_index(self);
+    tiny_queue_peek_partial(&self->request_queue, &selected, sizeof(selected), 0, selected_index);
+
+    if(selected.address != self->last_address) {
+      prefer_request_to_last_address(self, selected.priority, &selected_index);
+    }
+  }
+
+  if(selected_index == 0) {
+    self->priority_burst_count = 0;
+  }
+  else {
+    self->priority_burst_count++;
+  }
+
+  tiny_queue_peek_partial(&self->request_queue, &selected, sizeof(selected), 0, selected_index);
+
+  if(selected.address == self->last_address) {
+    self->address_run_count++;
+  }
+  else {
+    self->last_address = selected.address;
+    self->address_run_count = 1;
+  }
+
+  return selected_index;
+}
+
+static void advance_request_id(self_t* self)
+{
+  uint8_t count = self->configuration->request_id_count;
+  uint8_t offset = (uint8_t)(self->request_id - self->configuration->first_request_id + 1);
+
+  if((count != 0) && (offset >= count)) {
+    offset = 0;
+  }
+
+  self->request_id = (tiny_gea3_erd_api_request_id_t)(self->configuration->first_request_id + offset);
+}
+
+// Requests that finish as they are selected (unacknowledged writes and expired requests) call back
+// into this when they complete. Rather than recursing once per request, the nested call returns and
+// the loop sends the next request.
 static void send_request_if_not_busy(self_t* self)
 {
-  if(!self->busy && request_pending(self)) {
+  if(self->sending_requests) {
+    return;
+  }
+
+  self->sending_requests = true;
+
+  while(!self->busy && request_pending(self)) {
     self->busy = true;
+    self->active_index = next_request_index(self);
+
+    if(request_expired(self)) {
+      expire_request(self);
+      continue;
+    }
+
     self->remaining_retries = self->configuration->request_retries;
     send_request(self);
   }
+
+  self->sending_requests = false;
 }
 
-static void finish_request(self_t* self)
+static void remove_active_request(self_t* self)
 {
-  tiny_queue_discard(&self->request_queue);
+  tiny_queue_remove(&self->request_queue, self->active_index);
   disarm_request_timeout(self);
-  self->request_id++;
+  advance_request_id(self);
   self->busy = false;
+}
+
+static void finish_request(self_t* self)
+{
+  remove_active_request(self);
   send_request_if_not_busy(self);
 }
 
@@ -375,13 +730,13 @@ static void handle_read_failure(self_t* self, tiny_gea3_erd_client_read_failure_
 {
   read_request_t request;
   uint16_t size;
-  tiny_queue_peek(&self->request_queue, &request, &size, 0);
+  tiny_queue_peek(&self->request_queue, &request, &size, self->active_index);
 
   tiny_gea3_erd_client_on_activity_args_t args;
   args.address = request.address;
   args.type = tiny_gea3_erd_client_activity_type_read_failed;
   args.read_failed.erd = request.erd;
-  args.read_failed.request_id = self->request_id;
+  args.read_failed.request_id = request.request_id;
   args.read_failed.reason = reason;
 
   finish_request(self);
@@ -400,12 +755,12 @@ static void HandleWriteFailureWorker(void* _context, void* allocated_block)
   reinterpret(request, allocated_block, write_request_t*);
 
   uint16_t size;
-  tiny_queue_peek(&context->self->request_queue, request, &size, 0);
+  tiny_queue_peek(&context->self->request_queue, request, &size, context->self->active_index);
 
   tiny_gea3_erd_client_on_activity_args_t args;
   args.address = request->address;
   args.type = tiny_gea3_erd_client_activity_type_write_failed;
-  args.write_failed.request_id = context->self->request_id;
+  args.write_failed.request_id = request->request_id;
   args.write_failed.erd = request->erd;
   args.write_failed.data = request->data;
   args.write_failed.data_size = request->data_size;
@@ -419,7 +774,7 @@ static void HandleWriteFailureWorker(void* _context, void* allocated_block)
 static void handle_write_failure(self_t* self, tiny_gea3_erd_client_write_failure_reason_t reason)
 {
   write_request_t request;
-  tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, 0);
+  tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, self->active_index);
 
   handle_write_failure_context_t context = { self, reason };
   tiny_stack_allocator_allocate_aligned(request.data_size + offsetof(write_request_t, data), &context, HandleWriteFailureWorker);
@@ -429,7 +784,7 @@ static void handle_subscribe_failure(self_t* self)
 {
   read_request_t request;
   uint16_t size;
-  tiny_queue_peek(&self->request_queue, &request, &size, 0);
+  tiny_queue_peek(&self->request_queue, &request, &size, self->active_index);
 
   tiny_gea3_erd_client_on_activity_args_t args;
   args.address = request.address;
@@ -440,6 +795,46 @@ static void handle_subscribe_failure(self_t* self)
   tiny_event_publish(&self->on_activity, &args);
 }
 
+static void complete_batch(self_t* self)
+{
+  batch_request_t request;
+  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
+
+  uint8_t failed_count = 0;
+  for(uint8_t i = 0; i < request.item_count; i++) {
+    if(request.items[i].status != tiny_gea3_erd_client_batch_item_status_completed) {
+      failed_count++;
+    }
+  }
+
+  tiny_gea3_erd_client_on_activity_args_t args;
+  args.address = request.address;
+  args.type = tiny_gea3_erd_client_activity_type_batch_completed;
+  args.batch_completed.request_id = request.request_id;
+  args.batch_completed.items = request.items;
+  args.batch_completed.item_count = request.item_count;
+  args.batch_completed.failed_count = failed_count;
+
+  finish_request(self);
+
+  tiny_event_publish(&self->on_activity, &args);
+}
+
+static void finish_batch_item(self_t* self, tiny_gea3_erd_client_batch_item_status_t status)
+{
+  current_batch_item(self)->status = status;
+
+  if(current_batch_item(self)) {
+    disarm_request_timeout(self);
+    advance_request_id(self);
+    self->remaining_retries = self->configuration->request_retries;
+    send_request(self);
+  }
+  else {
+    complete_batch(self);
+  }
+}
+
 static void fail_request(self_t* self, uint8_t reason)
 {
   switch(request_type(self)) {
@@ -448,18 +843,46 @@ static void fail_request(self_t* self, uint8_t reason)
       break;
 
     case request_type_write:
+    case request_type_unacknowledged_write:
       handle_write_failure(self, reason);
       break;
 
     case request_type_subscribe:
       handle_subscribe_failure(self);
       break;
+
+    case request_type_read_batch:
+    case request_type_write_batch:
+      finish_batch_item(self, tiny_gea3_erd_client_batch_item_status_retries_exhausted);
+      break;
+  }
+}
+
+static void expire_request(self_t* self)
+{
+  switch(request_type(self)) {
+    case request_type_read:
+    case request_type_gather_read:
+      handle_read_failure(self, tiny_gea3_erd_client_read_failure_reason_deadline_expired);
+      break;
+
+    case request_type_write:
+    case request_type_unacknowledged_write:
+      handle_write_failure(self, tiny_gea3_erd_client_write_failure_reason_deadline_expired);
+      break;
+
+    case request_type_subscribe:
+      handle_subscribe_failure(self);
+      break;
   }
 }
 
 static void resend_request(self_t* self)
 {
-  if(self->remaining_retries > 0) {
+  if(request_expired(self)) {
+    expire_request(self);
+  }
+  else if(self->remaining_retries > 0) {
     self->remaining_retries--;
     send_request(self);
   }
@@ -468,11 +891,99 @@ static void resend_request(self_t* self)
   }
 }
 
+static void complete_gather_read(self_t* self)
+{
+  read_request_t request;
+  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
+
+  tiny_gea3_erd_client_on_activity_args_t args;
+  args.address = request.address;
+  args.type = tiny_gea3_erd_client_activity_type_gather_read_completed;
+  args.gather_read_completed.request_id = request.request_id;
+  args.gather_read_completed.erd = request.erd;
+  args.gather_read_completed.responder_count = self->gather_responder_count;
+
+  finish_request(self);
+
+  tiny_event_publish(&self->on_activity, &args);
+}
+
+static void handle_gather_read_response_packet(self_t* self, const tiny_gea_packet_t* packet)
+{
+  read_request_t request;
+  tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
+
+  reinterpret(payload, packet->payload, const tiny_gea3_erd_api_read_response_payload_t*);
+  tiny_erd_t erd = (payload->header.erd_msb << 8) + payload->header.erd_lsb;
+  uint8_t responder_mask = (uint8_t)(1 << (packet->source & 7));
+  bool already_responded = self->gather_responders[packet->source >> 3] & responder_mask;
+
+  if((self->request_id == payload->header.request_id) &&
+    (request.erd == erd) &&
+    (payload->header.result == tiny_gea3_erd_api_read_result_success) &&
+    !already_responded) {
+    self->gather_responders[packet->source >> 3] |= responder_mask;
+    self->gather_responder_count++;
+
+    tiny_gea3_erd_client_on_activity_args_t args;
+    args.address = packet->source;
+    args.type = tiny_gea3_erd_client_activity_type_read_completed;
+    args.read_completed.request_id = request.request_id;
+    args.read_completed.erd = erd;
+    args.read_completed.data_size = payload->header.data_size;
+    args.read_completed.data = payload->data;
+
+    tiny_event_publish(&self->on_activity, &args);
+  }
+}
+
+static bool batch_item_matches_response(
+  self_t* self,
+  const tiny_gea3_erd_client_batch_item_t* item,
+  const tiny_gea_packet_t* packet,
+  tiny_gea3_erd_api_request_id_t request_id,
+  tiny_erd_t erd)
+{
+  return (self->request_id == request_id) &&
+    ((item->address == packet->source) || (item->address == tiny_gea_broadcast_address)) &&
+    (item->erd == erd);
+}
+
+static void handle_batch_read_response_packet(self_t* self, const tiny_gea_packet_t* packet)
+{
+  tiny_gea3_erd_client_batch_item_t* item = current_batch_item(self);
+
+  reinterpret(payload, packet->payload, const tiny_gea3_erd_api_read_response_payload_t*);
+  tiny_erd_t erd = (payload->header.erd_msb << 8) + payload->header.erd_lsb;
+
+  if(batch_item_matches_response(self, item, packet, payload->header.request_id, erd)) {
+    if(payload->header.result == tiny_gea3_erd_api_read_result_success) {
+      if(payload->header.data_size <= item->data_size) {
+        memcpy(item->data, payload->data, payload->header.data_size);
+        item->data_size = payload->header.data_size;
+        finish_batch_item(self, tiny_gea3_erd_client_batch_item_status_completed);
+      }
+      else {
+        finish_batch_item(self, tiny_gea3_erd_client_batch_item_status_incorrect_size);
+      }
+    }
+    else if(payload->header.result == tiny_gea3_erd_api_read_result_unsupported_erd) {
+      finish_batch_item(self, tiny_gea3_erd_client_batch_item_status_not_supported);
+    }
+  }
+}
+
 static void handle_read_response_packet(self_t* self, const tiny_gea_packet_t* packet)
 {
-  if(request_type(self) == request_type_read) {
+  if(request_type(self) == request_type_gather_read) {
+    handle_gather_read_response_packet(self, packet);
+  }
+  else if(request_type(self) == request_type_read_batch) {
+    handle_batch_read_response_packet(self, packet);
+  }
+  else if(request_type(self) == request_type_read) {
     read_request_t request;
-    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
+    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
 
     reinterpret(payload, packet->payload, const tiny_gea3_erd_api_read_response_payload_t*);
     tiny_erd_t erd = (payload->header.erd_msb << 8) + payload->header.erd_lsb;
@@ -485,7 +996,7 @@ static void handle_read_response_packet(self_t* self, const tiny_gea_packet_t* p
         tiny_gea3_erd_client_on_activity_args_t args;
         args.address = packet->source;
         args.type = tiny_gea3_erd_client_activity_type_read_completed;
-        args.read_completed.request_id = request_id;
+        args.read_completed.request_id = request.request_id;
         args.read_completed.erd = erd;
         args.read_completed.data_size = payload->header.data_size;
         args.read_completed.data = payload->data;
@@ -512,12 +1023,12 @@ static void handle_write_response_packet_worker(void* _context, void* allocated_
   reinterpret(request, allocated_block, write_request_t*);
 
   uint16_t size;
-  tiny_queue_peek(&context->self->request_queue, request, &size, 0);
+  tiny_queue_peek(&context->self->request_queue, request, &size, context->self->active_index);
 
   tiny_gea3_erd_client_on_activity_args_t args;
   args.address = context->clientAddress;
   args.type = tiny_gea3_erd_client_activity_type_write_completed;
-  args.write_completed.request_id = context->self->request_id;
+  args.write_completed.request_id = request->request_id;
   args.write_completed.erd = request->erd;
   args.write_completed.data = request->data;
   args.write_completed.data_size = request->data_size;
@@ -527,11 +1038,64 @@ static void handle_write_response_packet_worker(void* _context, void* allocated_
   tiny_event_publish(&context->self->on_activity, &args);
 }
 
+static void complete_unacknowledged_write_worker(void* context, void* allocated_block)
+{
+  reinterpret(self, context, self_t*);
+  reinterpret(request, allocated_block, write_request_t*);
+
+  uint16_t size;
+  tiny_queue_peek(&self->request_queue, request, &size, self->active_index);
+
+  tiny_gea3_erd_client_on_activity_args_t args;
+  args.address = request->address;
+  args.type = tiny_gea3_erd_client_activity_type_write_completed;
+  args.write_completed.request_id = request->request_id;
+  args.write_completed.erd = request->erd;
+  args.write_completed.data = request->data;
+  args.write_completed.data_size = request->data_size;
+
+  // Publish before sending the next request so that back-to-back unacknowledged writes complete in
+  // the order they were sent
+  remove_active_request(self);
+  tiny_event_publish(&self->on_activity, &args);
+  send_request_if_not_busy(self);
+}
+
+static void complete_unacknowledged_write(self_t* self)
+{
+  uint16_t size;
+  tiny_queue_peek_size(&self->request_queue, &size, self->active_index);
+  tiny_stack_allocator_allocate_aligned(size, self, complete_unacknowledged_write_worker);
+}
+
+static void handle_batch_write_response_packet(self_t* self, const tiny_gea_packet_t* packet)
+{
+  tiny_gea3_erd_client_batch_item_t* item = current_batch_item(self);
+
+  reinterpret(payload, packet->payload, const tiny_gea3_erd_api_write_response_payload_t*);
+  tiny_erd_t erd = (payload->erd_msb << 8) + payload->erd_lsb;
+
+  if(batch_item_matches_response(self, item, packet, payload->request_id, erd)) {
+    if(payload->result == tiny_gea3_erd_api_write_result_success) {
+      finish_batch_item(self, tiny_gea3_erd_client_batch_item_status_completed);
+    }
+    else if(payload->result == tiny_gea3_erd_api_write_result_incorrect_size) {
+      finish_batch_item(self, tiny_gea3_erd_client_batch_item_status_incorrect_size);
+    }
+    else if(payload->result == tiny_gea3_erd_api_write_result_unsupported_erd) {
+      finish_batch_item(self, tiny_gea3_erd_client_batch_item_status_not_supported);
+    }
+  }
+}
+
 static void handle_write_response_packet(self_t* self, const tiny_gea_packet_t* packet)
 {
-  if(request_type(self) == request_type_write) {
+  if(request_type(self) == request_type_write_batch) {
+    handle_batch_write_response_packet(self, packet);
+  }
+  else if(request_type(self) == request_type_write) {
     write_request_t request;
-    tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, 0);
+    tiny_queue_peek_partial(&self->request_queue, &request, offsetof(write_request_t, data), 0, self->active_index);
 
     reinterpret(payload, packet->payload, const tiny_gea3_erd_api_write_response_payload_t*);
     tiny_erd_t erd = (payload->erd_msb << 8) + payload->erd_lsb;
@@ -559,7 +1123,7 @@ static void handle_subscribe_all_response_packet(self_t* self, const tiny_gea_pa
 {
   if(request_type(self) == request_type_subscribe) {
     subscribe_request_t request;
-    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, 0);
+    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, self->active_index);
 
     reinterpret(payload, packet->payload, const tiny_gea3_erd_api_subscribe_all_response_payload_t*);
     tiny_gea3_erd_api_request_id_t request_id = payload->request_id;
@@ -614,26 +1178,28 @@ static void handle_subscription_publication_packet(self_t* self, const tiny_gea_
 {
   reinterpret(payload, packet->payload, const tiny_gea3_erd_api_publication_header_t*);
 
-  uint8_t count = payload->erd_count;
-  uint8_t offset = sizeof(*payload);
-
-  for(uint8_t i = 0; i < count; i++) {
-    tiny_erd_t erd = (packet->payload[offset++] << 8);
-    erd += packet->payload[offset++];
-
-    uint8_t data_size = packet->payload[offset++];
+  tiny_gea_erd_view_t view;
+  tiny_gea_erd_view_init_from_packet(&view, packet, sizeof(*payload), payload->erd_count);
 
+  tiny_gea_erd_view_entry_t entry;
+  while(tiny_gea_erd_view_next(&view, &entry)) {
     tiny_gea3_erd_client_on_activity_args_t args;
     args.address = packet->source;
     args.type = tiny_gea3_erd_client_activity_type_subscription_publication_received;
-    args.subscription_publication_received.erd = erd;
-    args.subscription_publication_received.data_size = data_size;
-    args.subscription_publication_received.data = &packet->payload[offset];
+    args.subscription_publication_received.erd = entry.erd;
+    args.subscription_publication_received.data_size = entry.data_size;
+    args.subscription_publication_received.data = entry.data;
     tiny_event_publish(&self->on_activity, &args);
-
-    offset += data_size;
   }
 
+  tiny_gea3_erd_client_on_activity_args_t args;
+  args.address = packet->source;
+  args.type = tiny_gea3_erd_client_activity_type_subscription_publication_batch_received;
+  args.subscription_publication_batch_received.entries = &packet->payload[sizeof(*payload)];
+  args.subscription_publication_batch_received.entries_size = packet->payload_length - sizeof(*payload);
+  args.subscription_publication_batch_received.erd_count = payload->erd_count;
+  tiny_event_publish(&self->on_activity, &args);
+
   uint8_t address = packet->source;
   uint8_t context = payload->context;
   uint8_t request_id = payload->request_id;
@@ -687,6 +1253,7 @@ typedef struct {
   requests_conflict_predicate_t requests_conflict_predicate;
   uint16_t i;
   uint16_t request_size;
+  tiny_gea3_erd_client_request_id_t queued_request_id;
   bool request_already_queued;
   bool request_conflict_found;
 } enqueue_request_if_unique_context_t;
@@ -700,7 +1267,15 @@ static void enqueue_request_if_unique_worker(void* _context, void* allocated_blo
 
   context->request_already_queued =
     (context->request_size == size) &&
-    (memcmp(context->request, allocated_block, size) == 0);
+    (memcmp(
+       (const uint8_t*)context->request + offsetof(request_t, deadline),
+       (const uint8_t*)allocated_block + offsetof(request_t, deadline),
+       size - offsetof(request_t, deadline)) == 0);
+
+  if(context->request_already_queued) {
+    reinterpret(queued_request, allocated_block, const request_t*);
+    context->queued_request_id = queued_request->request_id;
+  }
 
   if(context->requests_conflict_predicate) {
     context->request_conflict_found = context->requests_conflict_predicate(context->request, allocated_block);
@@ -709,9 +1284,9 @@ static void enqueue_request_if_unique_worker(void* _context, void* allocated_blo
 
 static bool enqueue_request_if_unique(
   self_t* self,
-  const void* request,
+  request_t* request,
   uint16_t request_size,
-  uint16_t* index,
+  tiny_gea3_erd_client_request_id_t* request_id,
   requests_conflict_predicate_t requests_conflict_predicate)
 {
   uint16_t count = tiny_queue_count(&self->request_queue);
@@ -733,7 +1308,7 @@ static bool enqueue_request_if_unique(
     tiny_stack_allocator_allocate_aligned(elementSize, &context, enqueue_request_if_unique_worker);
 
     if(context.request_already_queued) {
-      *index = i;
+      *request_id = context.queued_request_id;
       return true;
     }
 
@@ -742,8 +1317,16 @@ static bool enqueue_request_if_unique(
     }
   }
 
-  *index = count;
-  return tiny_queue_enqueue(&self->request_queue, request, request_size);
+  request->request_id = self->next_request_id;
+  request->queued_ticks = tiny_time_source_ticks(self->timer_group->time_source);
+  *request_id = request->request_id;
+
+  if(!tiny_queue_enqueue(&self->request_queue, request, request_size)) {
+    return false;
+  }
+
+  self->next_request_id++;
+  return true;
 }
 
 static bool read_request_conflicts(const request_t* new_request, const request_t* queued_request)
@@ -752,6 +1335,8 @@ static bool read_request_conflicts(const request_t* new_request, const request_t
 
   switch(queued_request->type) {
     case request_type_write:
+    case request_type_unacknowledged_write:
+    case request_type_write_batch:
       return true;
 
     default:
@@ -759,34 +1344,46 @@ static bool read_request_conflicts(const request_t* new_request, const request_t
   }
 }
 
-static bool read(i_tiny_gea3_erd_client_t* _self, tiny_gea3_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd)
+static const tiny_gea3_erd_client_request_options_t default_request_options = { 0 };
+
+static bool read_with_options(
+  i_tiny_gea3_erd_client_t* _self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const tiny_gea3_erd_client_request_options_t* options)
 {
   reinterpret(self, _self, self_t*);
 
-  uint16_t index;
   read_request_t request;
+  memset(&request, 0, sizeof(request));
+  request.deadline = options->deadline;
+  request.priority = options->priority;
   request.type = request_type_read;
   request.address = address;
   request.erd = erd;
   bool request_added_or_already_queued = enqueue_request_if_unique(
     self,
-    &request,
+    (request_t*)&request,
     sizeof(request),
-    &index,
+    request_id,
     read_request_conflicts);
 
-  *request_id = index + self->request_id;
-
   send_request_if_not_busy(self);
 
   return request_added_or_already_queued;
 }
 
+static bool read(i_tiny_gea3_erd_client_t* _self, tiny_gea3_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd)
+{
+  return read_with_options(_self, request_id, address, erd, &default_request_options);
+}
+
 typedef struct {
   self_t* self;
+  const tiny_gea3_erd_client_request_options_t* options;
   const void* data;
   tiny_erd_t erd;
-  uint16_t index;
   tiny_gea3_erd_client_request_id_t request_id;
   uint8_t address;
   uint8_t data_size;
@@ -799,7 +1396,11 @@ static bool write_request_conflicts(const request_t* new_request, const request_
 
   switch(queued_request->type) {
     case request_type_write:
+    case request_type_unacknowledged_write:
     case request_type_read:
+    case request_type_gather_read:
+    case request_type_read_batch:
+    case request_type_write_batch:
       return true;
 
     default:
@@ -812,29 +1413,38 @@ static void write_worker(void* _context, void* allocated_block)
   reinterpret(context, _context, write_context_t*);
   reinterpret(request, allocated_block, write_request_t*);
 
-  request->type = request_type_write;
+  memset(request, 0, offsetof(write_request_t, data));
+  request->deadline = context->options->deadline;
+  request->priority = context->options->priority;
+  request->type = context->options->unacknowledged ? request_type_unacknowledged_write : request_type_write;
   request->address = context->address;
   request->erd = context->erd;
   request->data_size = context->data_size;
   memcpy(request->data, context->data, context->data_size);
   context->request_added_or_already_queued = enqueue_request_if_unique(
     context->self,
-    request,
+    (request_t*)request,
     offsetof(write_request_t, data) + context->data_size,
-    &context->index,
+    &context->request_id,
     write_request_conflicts);
 
-  context->request_id = context->index + context->self->request_id;
-
   send_request_if_not_busy(context->self);
 }
 
-static bool write(i_tiny_gea3_erd_client_t* _self, tiny_gea3_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd, const void* data, uint8_t data_size)
+static bool write_with_options(
+  i_tiny_gea3_erd_client_t* _self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const void* data,
+  uint8_t data_size,
+  const tiny_gea3_erd_client_request_options_t* options)
 {
   reinterpret(self, _self, self_t*);
 
   write_context_t context;
   context.self = self;
+  context.options = options;
   context.address = address;
   context.erd = erd;
   context.data = data;
@@ -847,14 +1457,126 @@ static bool write(i_tiny_gea3_erd_client_t* _self, tiny_gea3_erd_client_request_
   return context.request_added_or_already_queued;
 }
 
+static bool write(i_tiny_gea3_erd_client_t* _self, tiny_gea3_erd_client_request_id_t* request_id, uint8_t address, tiny_erd_t erd, const void* data, uint8_t data_size)
+{
+  return write_with_options(_self, request_id, address, erd, data, data_size, &default_request_options);
+}
+
+static bool gather_read(i_tiny_gea3_erd_client_t* _self, tiny_gea3_erd_client_request_id_t* request_id, tiny_erd_t erd)
+{
+  reinterpret(self, _self, self_t*);
+
+  read_request_t request;
+  memset(&request, 0, sizeof(request));
+  request.deadline = default_request_options.deadline;
+  request.priority = default_request_options.priority;
+  request.type = request_type_gather_read;
+  request.address = tiny_gea_broadcast_address;
+  request.erd = erd;
+  bool request_added_or_already_queued = enqueue_request_if_unique(
+    self,
+    (request_t*)&request,
+    sizeof(request),
+    request_id,
+    read_request_conflicts);
+
+  send_request_if_not_busy(self);
+
+  return request_added_or_already_queued;
+}
+
+static bool batch_items_queued(self_t* self, const tiny_gea3_erd_client_batch_item_t* items)
+{
+  uint16_t count = tiny_queue_count(&self->request_queue);
+
+  for(uint16_t i = 0; i < count; i++) {
+    request_t request;
+    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, i);
+
+    if(is_batch(&request)) {
+      batch_request_t batch;
+      tiny_queue_peek_partial(&self->request_queue, &batch, sizeof(batch), 0, i);
+
+      if(batch.items == items) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Items are only reset once the batch has been queued so that resubmitting items that are already
+// queued or in flight is rejected without losing their progress
+static bool enqueue_batch(
+  self_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  tiny_gea3_erd_client_batch_item_t* items,
+  uint8_t item_count,
+  request_type_t type,
+  requests_conflict_predicate_t requests_conflict_predicate)
+{
+  if((item_count == 0) || batch_items_queued(self, items)) {
+    return false;
+  }
+
+  batch_request_t request;
+  memset(&request, 0, sizeof(request));
+  request.deadline = default_request_options.deadline;
+  request.priority = default_request_options.priority;
+  request.type = type;
+  request.address = tiny_gea_broadcast_address;
+  request.item_count = item_count;
+  request.items = items;
+  bool request_added_or_already_queued = enqueue_request_if_unique(
+    self,
+    (request_t*)&request,
+    sizeof(request),
+    request_id,
+    requests_conflict_predicate);
+
+  if(request_added_or_already_queued) {
+    for(uint8_t i = 0; i < item_count; i++) {
+      items[i].status = tiny_gea3_erd_client_batch_item_status_pending;
+    }
+  }
+
+  send_request_if_not_busy(self);
+
+  return request_added_or_already_queued;
+}
+
+static bool read_batch(
+  i_tiny_gea3_erd_client_t* _self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  tiny_gea3_erd_client_batch_item_t* items,
+  uint8_t item_count)
+{
+  reinterpret(self, _self, self_t*);
+  return enqueue_batch(self, request_id, items, item_count, request_type_read_batch, read_request_conflicts);
+}
+
+static bool write_batch(
+  i_tiny_gea3_erd_client_t* _self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  tiny_gea3_erd_client_batch_item_t* items,
+  uint8_t item_count)
+{
+  reinterpret(self, _self, self_t*);
+  return enqueue_batch(self, request_id, items, item_count, request_type_write_batch, write_request_conflicts);
+}
+
 static bool subscribe_or_retain(self_t* self, uint8_t address, bool retain)
 {
-  uint16_t dummyIndex;
+  tiny_gea3_erd_client_request_id_t dummy_request_id;
   subscribe_request_t request;
+  memset(&request, 0, sizeof(request));
+  request.deadline = default_request_options.deadline;
+  request.priority = default_request_options.priority;
   request.type = request_type_subscribe;
   request.address = address;
   request.retain = retain;
-  bool request_added_or_already_queued = enqueue_request_if_unique(self, &request, sizeof(request), &dummyIndex, NULL);
+  bool request_added_or_already_queued = enqueue_request_if_unique(self, (request_t*)&request, sizeof(request), &dummy_request_id, NULL);
 
   send_request_if_not_busy(self);
 
@@ -873,13 +1595,66 @@ static bool retain_subscription(i_tiny_gea3_erd_client_t* _self, uint8_t address
   return subscribe_or_retain(self, address, true);
 }
 
+static bool find_request(self_t* self, tiny_gea3_erd_client_request_id_t request_id, uint16_t* index)
+{
+  uint16_t count = tiny_queue_count(&self->request_queue);
+
+  for(uint16_t i = 0; i < count; i++) {
+    request_t request;
+    tiny_queue_peek_partial(&self->request_queue, &request, sizeof(request), 0, i);
+
+    if(request.request_id == request_id) {
+      *index = i;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static bool cancel(i_tiny_gea3_erd_client_t* _self, tiny_gea3_erd_client_request_id_t request_id)
+{
+  reinterpret(self, _self, self_t*);
+
+  uint16_t index;
+  if(!find_request(self, request_id, &index)) {
+    return false;
+  }
+
+  if(self->busy && (index == self->active_index)) {
+    // Finishing the request advances the request ID sent on the wire so a late response will not match
+    finish_request(self);
+  }
+  else {
+    tiny_queue_remove(&self->request_queue, index);
+
+    if(self->busy && (index < self->active_index)) {
+      self->active_index--;
+    }
+  }
+
+  return true;
+}
+
 static i_tiny_event_t* on_activity(i_tiny_gea3_erd_client_t* _self)
 {
   reinterpret(self, _self, self_t*);
   return &self->on_activity.interface;
 }
 
-static const i_tiny_gea3_erd_client_api_t api = { read, write, subscribe, retain_subscription, on_activity };
+static const i_tiny_gea3_erd_client_api_t api = {
+  read,
+  write,
+  subscribe,
+  retain_subscription,
+  on_activity,
+  read_with_options,
+  write_with_options,
+  cancel,
+  gather_read,
+  read_batch,
+  write_batch
+};
 
 void tiny_gea3_erd_client_init(
   tiny_gea3_erd_client_t* self,
@@ -891,8 +1666,14 @@ void tiny_gea3_erd_client_init(
 {
   self->interface.api = &api;
 
-  self->request_id = 0;
+  self->request_id = configuration->first_request_id;
+  self->next_request_id = 0;
+  self->active_index = 0;
+  self->priority_burst_count = 0;
+  self->last_address = tiny_gea_broadcast_address;
+  self->address_run_count = 0;
   self->busy = false;
+  self->sending_requests = false;
   self->gea3_interface = gea3_interface;
   self->configuration = configuration;
   self->timer_group = timer_group;
@@ -0,0 +1,180 @@
+/*!
+ * @file
+ * @brief
+ */
+
+#include <string.h>
+#include "tiny_gea3_erd_api.h"
+#include "tiny_gea3_erd_client_router.h"
+#include "tiny_utils.h"
+
+enum {
+  no_owner = 0xFF
+};
+
+typedef tiny_gea3_erd_client_router_t self_t;
+typedef tiny_gea3_erd_client_router_port_t port_t;
+
+typedef struct {
+  self_t* self;
+  uint8_t port_index;
+  void* context;
+  tiny_gea_interface_send_callback_t callback;
+} send_context_t;
+
+static bool is_request(const tiny_gea_packet_t* packet)
+{
+  if(packet->payload_length < 2) {
+    return false;
+  }
+
+  switch(packet->payload[0]) {
+    case tiny_gea3_erd_api_command_read_request:
+    case tiny_gea3_erd_api_command_write_request:
+    case tiny_gea3_erd_api_command_subscribe_all_request:
+      return true;
+  }
+
+  return false;
+}
+
+static bool is_response(const tiny_gea_packet_t* packet)
+{
+  if(packet->payload_length < 2) {
+    return false;
+  }
+
+  switch(packet->payload[0]) {
+    case tiny_gea3_erd_api_command_read_response:
+    case tiny_gea3_erd_api_command_write_response:
+    case tiny_gea3_erd_api_command_subscribe_all_response:
+      return true;
+  }
+
+  return false;
+}
+
+static uint16_t request_ids_per_port(self_t* self)
+{
+  return (uint16_t)(256 / self->port_count);
+}
+
+// Only IDs in the sending port's range are recorded so a client that is configured with the wrong
+// range cannot take ownership of another port's requests
+static bool in_range(self_t* self, uint8_t port_index, uint8_t request_id)
+{
+  return (request_id / request_ids_per_port(self)) == port_index;
+}
+
+static void send_worker(void* _context, tiny_gea_packet_t* packet)
+{
+  reinterpret(context, _context, send_context_t*);
+
+  context->callback(context->context, packet);
+
+  if(is_request(packet) && in_range(context->self, context->port_index, packet->payload[1])) {
+    context->self->owners[packet->payload[1]] = context->port_index;
+  }
+}
+
+static uint8_t port_index(self_t* self, port_t* port)
+{
+  return (uint8_t)(port - self->ports);
+}
+
+static bool send(
+  i_tiny_gea_interface_t* _port,
+  uint8_t destination,
+  uint8_t payload_length,
+  void* context,
+  tiny_gea_interface_send_callback_t callback)
+{
+  reinterpret(port, _port, port_t*);
+  self_t* self = port->router;
+
+  send_context_t send_context = { self, port_index(self, port), context, callback };
+  return tiny_gea_interface_send(self->gea3_interface, destination, payload_length, &send_context, send_worker);
+}
+
+static bool forward(
+  i_tiny_gea_interface_t* _port,
+  uint8_t destination,
+  uint8_t payload_length,
+  void* context,
+  tiny_gea_interface_send_callback_t callback)
+{
+  reinterpret(port, _port, port_t*);
+  self_t* self = port->router;
+
+  send_context_t send_context = { self, port_index(self, port), context, callback };
+  return tiny_gea_interface_forward(self->gea3_interface, destination, payload_length, &send_context, send_worker);
+}
+
+static i_tiny_event_t* on_receive(i_tiny_gea_interface_t* _port)
+{
+  reinterpret(port, _port, port_t*);
+  return &port->on_receive.interface;
+}
+
+static const i_tiny_gea_interface_api_t port_api = { send, forward, on_receive };
+
+static void packet_received(void* context, const void* _args)
+{
+  reinterpret(self, context, self_t*);
+  reinterpret(args, _args, const tiny_gea_interface_on_receive_args_t*);
+  const tiny_gea_packet_t* packet = args->packet;
+
+  if(is_response(packet)) {
+    uint8_t owner = self->owners[packet->payload[1]];
+
+    if(owner != no_owner) {
+      tiny_event_publish(&self->ports[owner].on_receive, args);
+      return;
+    }
+  }
+
+  for(uint8_t i = 0; i < self->port_count; i++) {
+    tiny_event_publish(&self->ports[i].on_receive, args);
+  }
+}
+
+void tiny_gea3_erd_client_router_init(
+  tiny_gea3_erd_client_router_t* self,
+  i_tiny_gea_interface_t* gea3_interface,
+  tiny_gea3_erd_client_router_port_t* ports,
+  uint8_t port_count)
+{
+  self->gea3_interface = gea3_interface;
+  self->ports = ports;
+  self->port_count = port_count;
+
+  memset(self->owners, no_owner, sizeof(self->owners));
+
+  for(uint8_t i = 0; i < port_count; i++) {
+    ports[i].interface.api = &port_api;
+    ports[i].router = self;
+    tiny_event_init(&ports[i].on_receive);
+  }
+
+  tiny_event_subscription_init(&self->packet_received, self, packet_received);
+  tiny_event_subscribe(tiny_gea_interface_on_receive(gea3_interface), &self->packet_received);
+}
+
+i_tiny_gea_interface_t* tiny_gea3_erd_client_router_port(
+  tiny_gea3_erd_client_router_t* self,
+  uint8_t index)
+{
+  return &self->ports[index].interface;
+}
+
+void tiny_gea3_erd_client_router_configure_port(
+  tiny_gea3_erd_client_router_t* self,
+  uint8_t index,
+  tiny_gea3_erd_client_configuration_t* configuration)
+{
+  uint16_t count = request_ids_per_port(self);
+
+  configuration->first_request_id = (tiny_gea3_erd_api_request_id_t)(index * count);
+  // A count of 256 wraps to 0, which the client treats as every ID
+  configuration->request_id_count = (uint8_t)count;
+}
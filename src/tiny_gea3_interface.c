@@ -13,6 +13,11 @@
  * this operation is pending the interrupt context is not free to begin
  * sending any additional packets.
  *
+ * When a priority send queue is used, the non-interrupt context selects the
+ * queue to send from before setting the send in progress flag and does not
+ * change the selection until the send has completed. The interrupt context
+ * only peeks from the selected queue.
+ *
  * The non-interrupt context sets the send.in_progress flag and clears
  * the send.completed flag. While send.completed remains false, the first
  * element of the queue is not modified.
@@ -56,6 +61,13 @@
  * receive buffer. After a received packet has been processed by the non-
  * interrupt context, the it clears the flag to indicate that it is ready for
  * use by the interrupt context.
+ *
+ * When a receive pool is used, the non-interrupt context may switch the receive
+ * buffer to another block allocated from the pool. It only does this while the
+ * receive.packet_ready flag is set so the interrupt context never sees the
+ * switch. If a packet is retained and no block can be allocated to switch to
+ * then the flag is left set, and packets are dropped, until a packet is
+ * released.
  */
 
 #include <stdbool.h>
@@ -103,18 +115,34 @@ static bool received_packet_has_valid_length(self_t* self)
   return (packet->payload_length == self->receive_count + unbuffered_bytes);
 }
 
+static bool destination_is_accepted(self_t* self, uint8_t destination)
+{
+  return (destination == self->address) ||
+    (destination == tiny_gea_broadcast_address) ||
+    (self->ignore_destination_address) ||
+    (self->address_filter && (self->address_filter[destination >> 3] & (1 << (destination & 7))));
+}
+
 static bool received_packet_is_addressed_to_me(self_t* self)
 {
   reinterpret(packet, self->receive_buffer, tiny_gea_packet_t*);
-  return (packet->destination == self->address) ||
-    (packet->destination == tiny_gea_broadcast_address) ||
-    (self->ignore_destination_address);
+  return destination_is_accepted(self, packet->destination);
 }
 
 static void buffer_received_byte(self_t* self, uint8_t byte)
 {
+  // Bytes are only buffered for a packet that is in progress and addressed to us
+  if(!self->stx_received) {
+    return;
+  }
+
   if(self->receive_count == 0) {
     self->receive_crc = tiny_gea_crc_seed;
+
+    if(!destination_is_accepted(self, byte)) {
+      self->stx_received = false;
+      return;
+    }
   }
 
   if(self->receive_count < self->receive_buffer_size) {
@@ -130,14 +158,17 @@ static void byte_received(void* context, const void* _args)
 {
   reinterpret(self, context, self_t*);
   reinterpret(args, _args, const tiny_uart_on_receive_args_t*);
-  reinterpret(packet, self->receive_buffer, tiny_gea_packet_t*);
-  uint8_t byte = args->byte;
 
+  tiny_gea3_interface_byte_received(self, args->byte);
+}
+
+void tiny_gea3_interface_byte_received(tiny_gea3_interface_t* self, uint8_t byte)
+{
   if(self->receive_packet_ready) {
     return;
   }
 
-  if(self->receive_escaped) {
+  if(self->receive_escaped || !needs_escape(byte)) {
     self->receive_escaped = false;
     buffer_received_byte(self, byte);
     return;
@@ -159,6 +190,7 @@ static void byte_received(void* context, const void* _args)
         received_packet_has_valid_length(self) &&
         received_packet_has_valid_crc(self) &&
         received_packet_is_addressed_to_me(self)) {
+        reinterpret(packet, self->receive_buffer, tiny_gea_packet_t*);
         packet->payload_length -= tiny_gea_packet_transmission_overhead;
         self->receive_packet_ready = true;
       }
@@ -185,9 +217,19 @@ static bool determine_byte_to_send_considering_escapes(self_t* self, uint8_t byt
   return !self->send_escaped;
 }
 
+static tiny_queue_t* next_send_queue(self_t* self)
+{
+  if(self->priority_commands && (tiny_queue_count(&self->priority_send_queue) > 0)) {
+    return &self->priority_send_queue;
+  }
+
+  return &self->send_queue;
+}
+
 static void begin_send(self_t* self)
 {
-  tiny_queue_peek_partial(&self->send_queue, &self->send_data_length, sizeof(self->send_data_length), offsetof(tiny_gea_packet_t, payload_length), 0);
+  self->active_send_queue = next_send_queue(self);
+  tiny_queue_peek_partial(self->active_send_queue, &self->send_data_length, sizeof(self->send_data_length), offsetof(tiny_gea_packet_t, payload_length), 0);
   self->send_crc = tiny_gea_crc_seed;
   self->send_state = send_state_destination;
   self->send_offset = 0;
@@ -205,7 +247,7 @@ static void byte_sent(void* context, const void* args)
   switch(self->send_state) {
     case send_state_destination: {
       uint8_t destination;
-      tiny_queue_peek_partial(&self->send_queue, &destination, sizeof(destination), self->send_offset, 0);
+      tiny_queue_peek_partial(self->active_send_queue, &destination, sizeof(destination), self->send_offset, 0);
       if(determine_byte_to_send_considering_escapes(self, destination, &byte_to_send)) {
         self->send_crc = tiny_crc16_byte(self->send_crc, byte_to_send);
         self->send_offset++;
@@ -225,7 +267,7 @@ static void byte_sent(void* context, const void* args)
 
     case send_state_source: {
       uint8_t source;
-      tiny_queue_peek_partial(&self->send_queue, &source, sizeof(source), self->send_offset, 0);
+      tiny_queue_peek_partial(self->active_send_queue, &source, sizeof(source), self->send_offset, 0);
       if(determine_byte_to_send_considering_escapes(self, source, &byte_to_send)) {
         self->send_crc = tiny_crc16_byte(self->send_crc, byte_to_send);
         self->send_offset++;
@@ -241,7 +283,7 @@ static void byte_sent(void* context, const void* args)
 
     case send_state_data: {
       uint8_t data;
-      tiny_queue_peek_partial(&self->send_queue, &data, sizeof(data), self->send_offset, 0);
+      tiny_queue_peek_partial(self->active_send_queue, &data, sizeof(data), self->send_offset, 0);
       if(determine_byte_to_send_considering_escapes(self, data, &byte_to_send)) {
         self->send_crc = tiny_crc16_byte(self->send_crc, byte_to_send);
         self->send_offset++;
@@ -289,6 +331,19 @@ typedef struct {
   bool queued;
 } send_worker_context_t;
 
+static tiny_queue_t* send_queue_for_packet(self_t* self, const tiny_gea_packet_t* packet, uint8_t payload_length)
+{
+  if(self->priority_commands && (payload_length > 0)) {
+    uint8_t command = packet->payload[0];
+
+    if(self->priority_commands[command / 8] & (1 << (command % 8))) {
+      return &self->priority_send_queue;
+    }
+  }
+
+  return &self->send_queue;
+}
+
 static void send_worker_callback(void* _context, void* buffer)
 {
   send_worker_context_t* context = _context;
@@ -303,7 +358,10 @@ static void send_worker_callback(void* _context, void* buffer)
   packet->payload_length += tiny_gea_packet_transmission_overhead;
   packet->destination = context->destination;
 
-  context->queued = tiny_queue_enqueue(&context->self->send_queue, buffer, payload_length + tiny_gea_packet_overhead);
+  context->queued = tiny_queue_enqueue(
+    send_queue_for_packet(context->self, packet, payload_length),
+    buffer,
+    payload_length + tiny_gea_packet_overhead);
 }
 
 static bool send_worker(
@@ -386,6 +444,7 @@ void tiny_gea3_interface_init(
   self->receive_buffer = receive_buffer;
   self->receive_buffer_size = receive_buffer_size;
   self->ignore_destination_address = ignore_destination_address;
+  self->address_filter = NULL;
   self->receive_escaped = false;
   self->send_in_progress = false;
   self->send_completed = false;
@@ -393,10 +452,15 @@ void tiny_gea3_interface_init(
   self->stx_received = false;
   self->receive_packet_ready = false;
   self->receive_count = 0;
+  self->receive_pool = NULL;
+  self->receive_buffer_retained = false;
+  self->waiting_for_receive_buffer = false;
 
   tiny_event_init(&self->on_receive);
 
   tiny_queue_init(&self->send_queue, send_queue_buffer, send_queue_buffer_size);
+  self->active_send_queue = &self->send_queue;
+  self->priority_commands = NULL;
 
   tiny_event_subscription_init(&self->byte_received_subscription, self, byte_received);
   tiny_event_subscription_init(&self->byte_sent_subscription, self, byte_sent);
@@ -405,26 +469,125 @@ void tiny_gea3_interface_init(
   tiny_event_subscribe(tiny_uart_on_send_complete(uart), &self->byte_sent_subscription);
 }
 
+static bool switch_to_a_new_receive_buffer(self_t* self)
+{
+  tiny_gea_packet_t* packet = tiny_gea_packet_pool_allocate(self->receive_pool);
+
+  if(!packet) {
+    return false;
+  }
+
+  self->receive_buffer = (uint8_t*)packet;
+  self->receive_buffer_retained = false;
+  return true;
+}
+
 void tiny_gea3_interface_run(self_t* self)
 {
-  if(self->receive_packet_ready) {
+  if(self->receive_packet_ready && !self->waiting_for_receive_buffer) {
     tiny_gea_interface_on_receive_args_t args;
     args.packet = (const tiny_gea_packet_t*)self->receive_buffer;
     tiny_event_publish(&self->on_receive, &args);
 
-    // Can only be cleared _after_ publication so that the buffer isn't reused
-    self->receive_packet_ready = false;
+    if(self->receive_buffer_retained && !switch_to_a_new_receive_buffer(self)) {
+      self->waiting_for_receive_buffer = true;
+    }
+    else {
+      // Can only be cleared _after_ publication so that the buffer isn't reused
+      self->receive_packet_ready = false;
+    }
   }
 
   if(self->send_completed) {
-    tiny_queue_discard(&self->send_queue);
+    tiny_queue_discard(self->active_send_queue);
     self->send_completed = false;
     self->send_in_progress = false;
   }
 
   if(!self->send_in_progress) {
-    if(tiny_queue_count(&self->send_queue) > 0) {
+    if(tiny_queue_count(next_send_queue(self)) > 0) {
       begin_send(self);
     }
   }
 }
+
+void tiny_gea3_interface_set_address_filter(
+  tiny_gea3_interface_t* self,
+  const uint8_t* address_filter)
+{
+  self->address_filter = address_filter;
+}
+
+void tiny_gea3_interface_use_priority_send_queue(
+  tiny_gea3_interface_t* self,
+  uint8_t* priority_send_queue_buffer,
+  size_t priority_send_queue_buffer_size,
+  const uint8_t* priority_commands)
+{
+  tiny_queue_init(&self->priority_send_queue, priority_send_queue_buffer, priority_send_queue_buffer_size);
+  self->priority_commands = priority_commands;
+}
+
+void tiny_gea3_interface_use_receive_pool(
+  tiny_gea3_interface_t* self,
+  tiny_gea_packet_pool_t* pool)
+{
+  tiny_gea_packet_t* packet = tiny_gea_packet_pool_allocate(pool);
+
+  if(!packet) {
+    return;
+  }
+
+  self->receive_pool = pool;
+  self->receive_buffer = (uint8_t*)packet;
+  self->receive_buffer_size = (pool->block_size > UINT8_MAX) ? UINT8_MAX : (uint8_t)pool->block_size;
+  self->receive_buffer_retained = false;
+}
+
+bool tiny_gea3_interface_retain(
+  tiny_gea3_interface_t* self,
+  const tiny_gea_packet_t* packet)
+{
+  if(!self->receive_pool || !self->receive_packet_ready || ((const void*)packet != self->receive_buffer)) {
+    return false;
+  }
+
+  self->receive_buffer_retained = true;
+  return true;
+}
+
+void tiny_gea3_interface_release(
+  tiny_gea3_interface_t* self,
+  const tiny_gea_packet_t* packet)
+{
+  if(!self->receive_pool) {
+    return;
+  }
+
+  if((const void*)packet == self->receive_buffer) {
+    if(self->receive_buffer_retained) {
+      // Keep receiving into the block instead of returning it to the pool
+      self->receive_buffer_retained = false;
+
+      if(self->waiting_for_receive_buffer) {
+        self->waiting_for_receive_buffer = false;
+        self->receive_packet_ready = false;
+      }
+    }
+
+    return;
+  }
+
+  // The pool ignores packets that it did not allocate or that are already free
+  tiny_gea_packet_pool_free(self->receive_pool, packet);
+
+  if(self->waiting_for_receive_buffer && switch_to_a_new_receive_buffer(self)) {
+    self->waiting_for_receive_buffer = false;
+    self->receive_packet_ready = false;
+  }
+}
+
+void tiny_gea3_interface_use_direct_byte_receive(tiny_gea3_interface_t* self)
+{
+  tiny_event_unsubscribe(tiny_uart_on_receive(self->uart), &self->byte_received_subscription);
+}
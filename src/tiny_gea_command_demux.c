@@ -0,0 +1,82 @@
+/*!
+ * @file
+ * @brief
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "tiny_gea_command_demux.h"
+#include "tiny_utils.h"
+
+typedef tiny_gea_command_demux_t self_t;
+
+static void packet_received(void* context, const void* _args)
+{
+  reinterpret(self, context, self_t*);
+  reinterpret(args, _args, const tiny_gea_interface_on_receive_args_t*);
+
+  if(args->packet->payload_length == 0) {
+    return;
+  }
+
+  tiny_gea_command_demux_handler_t* handler = self->handlers[args->packet->payload[0]];
+
+  // The next handler is kept in the demux so that removing it from a callback skips it
+  while(handler) {
+    self->next_handler = handler->next;
+    handler->callback(handler->context, args->packet);
+    handler = self->next_handler;
+  }
+}
+
+void tiny_gea_command_demux_init(
+  tiny_gea_command_demux_t* self,
+  i_tiny_gea_interface_t* gea_interface)
+{
+  memset(self->handlers, 0, sizeof(self->handlers));
+  self->next_handler = NULL;
+
+  tiny_event_subscription_init(&self->packet_received, self, packet_received);
+  tiny_event_subscribe(tiny_gea_interface_on_receive(gea_interface), &self->packet_received);
+}
+
+void tiny_gea_command_demux_add_handler(
+  tiny_gea_command_demux_t* self,
+  tiny_gea_command_demux_handler_t* handler,
+  uint8_t command,
+  void* context,
+  tiny_gea_command_demux_callback_t callback)
+{
+  handler->next = NULL;
+  handler->callback = callback;
+  handler->context = context;
+  handler->command = command;
+
+  tiny_gea_command_demux_handler_t** link = &self->handlers[command];
+
+  while(*link) {
+    link = &(*link)->next;
+  }
+
+  *link = handler;
+}
+
+void tiny_gea_command_demux_remove_handler(
+  tiny_gea_command_demux_t* self,
+  tiny_gea_command_demux_handler_t* handler)
+{
+  tiny_gea_command_demux_handler_t** link = &self->handlers[handler->command];
+
+  if(self->next_handler == handler) {
+    self->next_handler = handler->next;
+  }
+
+  while(*link) {
+    if(*link == handler) {
+      *link = handler->next;
+      return;
+    }
+
+    link = &(*link)->next;
+  }
+}
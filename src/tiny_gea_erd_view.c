@@ -0,0 +1,67 @@
+/*!
+ * @file
+ * @brief
+ */
+
+#include "tiny_gea_erd_view.h"
+
+enum {
+  record_header_size = sizeof(tiny_erd_t) + sizeof(uint8_t)
+};
+
+void tiny_gea_erd_view_init(
+  tiny_gea_erd_view_t* self,
+  const void* entries,
+  uint8_t entries_size,
+  uint8_t erd_count)
+{
+  self->next = entries;
+  self->end = self->next + entries_size;
+  self->remaining = erd_count;
+}
+
+bool tiny_gea_erd_view_init_from_packet(
+  tiny_gea_erd_view_t* self,
+  const tiny_gea_packet_t* packet,
+  uint8_t offset,
+  uint8_t erd_count)
+{
+  if(offset > packet->payload_length) {
+    return false;
+  }
+
+  tiny_gea_erd_view_init(self, &packet->payload[offset], packet->payload_length - offset, erd_count);
+
+  return true;
+}
+
+bool tiny_gea_erd_view_next(tiny_gea_erd_view_t* self, tiny_gea_erd_view_entry_t* entry)
+{
+  if(self->remaining == 0) {
+    return false;
+  }
+
+  if((self->end - self->next) < record_header_size) {
+    return false;
+  }
+
+  uint8_t data_size = self->next[2];
+
+  if((self->end - self->next - record_header_size) < data_size) {
+    return false;
+  }
+
+  entry->erd = (tiny_erd_t)((self->next[0] << 8) + self->next[1]);
+  entry->data_size = data_size;
+  entry->data = &self->next[record_header_size];
+
+  self->next += record_header_size + data_size;
+  self->remaining--;
+
+  return true;
+}
+
+bool tiny_gea_erd_view_complete(const tiny_gea_erd_view_t* self)
+{
+  return (self->remaining == 0) && (self->next == self->end);
+}
@@ -0,0 +1,146 @@
+/*!
+ * @file
+ * @brief
+ */
+
+#include <stddef.h>
+#include "tiny_gea_packet_pool.h"
+
+enum {
+  // 2 * capacity must fit in a uint8_t
+  max_capacity = 127
+};
+
+// Head and tail run from 0 to (2 * capacity - 1) so that a full queue can be told apart from an
+// empty queue without a shared count
+static uint8_t next_index(tiny_gea_packet_queue_t* self, uint8_t index)
+{
+  index++;
+  return (index == 2 * self->capacity) ? 0 : index;
+}
+
+static uint8_t slot(tiny_gea_packet_queue_t* self, uint8_t index)
+{
+  return (index >= self->capacity) ? (uint8_t)(index - self->capacity) : index;
+}
+
+void tiny_gea_packet_queue_init(
+  tiny_gea_packet_queue_t* self,
+  tiny_gea_packet_t** entries,
+  uint8_t entry_count)
+{
+  self->entries = entries;
+  self->capacity = (entry_count > max_capacity) ? (uint8_t)max_capacity : entry_count;
+  self->head = 0;
+  self->tail = 0;
+}
+
+uint8_t tiny_gea_packet_queue_count(tiny_gea_packet_queue_t* self)
+{
+  uint8_t head = self->head;
+  uint8_t tail = self->tail;
+  return (tail >= head) ? (uint8_t)(tail - head) : (uint8_t)(2 * self->capacity - head + tail);
+}
+
+bool tiny_gea_packet_queue_enqueue(tiny_gea_packet_queue_t* self, tiny_gea_packet_t* packet)
+{
+  if(tiny_gea_packet_queue_count(self) == self->capacity) {
+    return false;
+  }
+
+  self->entries[slot(self, self->tail)] = packet;
+  self->tail = next_index(self, self->tail);
+
+  return true;
+}
+
+tiny_gea_packet_t* tiny_gea_packet_queue_dequeue(tiny_gea_packet_queue_t* self)
+{
+  if(tiny_gea_packet_queue_count(self) == 0) {
+    return NULL;
+  }
+
+  tiny_gea_packet_t* packet = self->entries[slot(self, self->head)];
+  self->head = next_index(self, self->head);
+
+  return packet;
+}
+
+tiny_gea_packet_t* tiny_gea_packet_queue_peek(tiny_gea_packet_queue_t* self, uint8_t index)
+{
+  if(index >= tiny_gea_packet_queue_count(self)) {
+    return NULL;
+  }
+
+  uint16_t position = (uint16_t)self->head + index;
+  return self->entries[position % self->capacity];
+}
+
+void tiny_gea_packet_pool_init(
+  tiny_gea_packet_pool_t* self,
+  void* blocks,
+  uint8_t max_payload_length,
+  uint8_t block_count,
+  tiny_gea_packet_t** free_list)
+{
+  if(block_count > max_capacity) {
+    block_count = max_capacity;
+  }
+
+  self->blocks = blocks;
+  self->block_size = (uint16_t)(max_payload_length + tiny_gea_packet_overhead);
+  self->block_count = block_count;
+  self->max_payload_length = max_payload_length;
+  self->in_use = &self->blocks[block_count * self->block_size];
+
+  tiny_gea_packet_queue_init(&self->free_blocks, free_list, block_count);
+
+  for(uint8_t i = 0; i < block_count; i++) {
+    self->in_use[i] = false;
+    tiny_gea_packet_queue_enqueue(&self->free_blocks, (tiny_gea_packet_t*)&self->blocks[i * self->block_size]);
+  }
+}
+
+static bool block_index(tiny_gea_packet_pool_t* self, const tiny_gea_packet_t* packet, uint8_t* index)
+{
+  const uint8_t* block = (const uint8_t*)packet;
+  const uint8_t* end = &self->blocks[self->block_count * self->block_size];
+
+  if((block < self->blocks) || (block >= end) || ((size_t)(block - self->blocks) % self->block_size != 0)) {
+    return false;
+  }
+
+  *index = (uint8_t)((size_t)(block - self->blocks) / self->block_size);
+  return true;
+}
+
+tiny_gea_packet_t* tiny_gea_packet_pool_allocate(tiny_gea_packet_pool_t* self)
+{
+  tiny_gea_packet_t* packet = tiny_gea_packet_queue_dequeue(&self->free_blocks);
+  uint8_t index;
+
+  if(packet && block_index(self, packet, &index)) {
+    self->in_use[index] = true;
+    packet->payload_length = self->max_payload_length;
+  }
+
+  return packet;
+}
+
+void tiny_gea_packet_pool_free(tiny_gea_packet_pool_t* self, const tiny_gea_packet_t* packet)
+{
+  uint8_t index;
+
+  if(!block_index(self, packet, &index) || !self->in_use[index]) {
+    return;
+  }
+
+  // Cleared before the block is handed back so that allocation never sees a stale flag
+  self->in_use[index] = false;
+  tiny_gea_packet_queue_enqueue(&self->free_blocks, (tiny_gea_packet_t*)&self->blocks[index * self->block_size]);
+}
+
+uint8_t tiny_gea_packet_pool_available(tiny_gea_packet_pool_t* self)
+{
+  return tiny_gea_packet_queue_count(&self->free_blocks);
+}
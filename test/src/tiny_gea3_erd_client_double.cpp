@@ -57,6 +57,95 @@ static bool retain_subscription(i_tiny_gea3_erd_client_t* self, uint8_t address)
     .returnBoolValueOrDefault(true);
 }
 
+static bool read_with_options(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const tiny_gea3_erd_client_request_options_t* options)
+{
+  return mock()
+    .actualCall("read_with_options")
+    .onObject(self)
+    .withOutputParameter("request_id", request_id)
+    .withParameter("address", address)
+    .withParameter("erd", erd)
+    .withParameter("deadline", options->deadline)
+    .withParameter("priority", options->priority)
+    .returnBoolValueOrDefault(true);
+}
+
+static bool write_with_options(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  uint8_t address,
+  tiny_erd_t erd,
+  const void* data,
+  uint8_t dataSize,
+  const tiny_gea3_erd_client_request_options_t* options)
+{
+  return mock()
+    .actualCall("write_with_options")
+    .onObject(self)
+    .withOutputParameter("request_id", request_id)
+    .withParameter("address", address)
+    .withParameter("erd", erd)
+    .withMemoryBufferParameter("data", reinterpret_cast<const unsigned char*>(data), dataSize)
+    .withParameter("deadline", options->deadline)
+    .withParameter("priority", options->priority)
+    .withParameter("unacknowledged", options->unacknowledged)
+    .returnBoolValueOrDefault(true);
+}
+
+static bool cancel(i_tiny_gea3_erd_client_t* self, tiny_gea3_erd_client_request_id_t request_id)
+{
+  return mock()
+    .actualCall("cancel")
+    .onObject(self)
+    .withParameter("request_id", request_id)
+    .returnBoolValueOrDefault(true);
+}
+
+static bool gather_read(i_tiny_gea3_erd_client_t* self, tiny_gea3_erd_client_request_id_t* request_id, tiny_erd_t erd)
+{
+  return mock()
+    .actualCall("gather_read")
+    .onObject(self)
+    .withOutputParameter("request_id", request_id)
+    .withParameter("erd", erd)
+    .returnBoolValueOrDefault(true);
+}
+
+static bool read_batch(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  tiny_gea3_erd_client_batch_item_t* items,
+  uint8_t item_count)
+{
+  return mock()
+    .actualCall("read_batch")
+    .onObject(self)
+    .withOutputParameter("request_id", request_id)
+    .withParameter("items", static_cast<void*>(items))
+    .withParameter("item_count", item_count)
+    .returnBoolValueOrDefault(true);
+}
+
+static bool write_batch(
+  i_tiny_gea3_erd_client_t* self,
+  tiny_gea3_erd_client_request_id_t* request_id,
+  tiny_gea3_erd_client_batch_item_t* items,
+  uint8_t item_count)
+{
+  return mock()
+    .actualCall("write_batch")
+    .onObject(self)
+    .withOutputParameter("request_id", request_id)
+    .withParameter("items", static_cast<void*>(items))
+    .withParameter("item_count", item_count)
+    .returnBoolValueOrDefault(true);
+}
+
 static i_tiny_event_t* on_activity(i_tiny_gea3_erd_client_t* _self)
 {
   auto self = reinterpret_cast<tiny_gea3_erd_client_double_t*>(_self);
@@ -68,7 +157,13 @@ static const i_tiny_gea3_erd_client_api_t api = {
   write,
   subscribe,
   retain_subscription,
-  on_activity
+  on_activity,
+  read_with_options,
+  write_with_options,
+  cancel,
+  gather_read,
+  read_batch,
+  write_batch
 };
 
 void tiny_gea3_erd_client_double_init(tiny_gea3_erd_client_double_t* self)
@@ -0,0 +1,152 @@
+/*!
+ * @file
+ * @brief
+ */
+
+extern "C" {
+#include "tiny_gea2_backoff.h"
+}
+
+#include "CppUTest/TestHarness.h"
+
+enum {
+  address = 0xAD,
+  address_slots = address & 0x1F
+};
+
+static const tiny_gea2_interface_timing_t timing = {
+  .reflection_timeout = 6,
+  .ack_timeout = 8,
+  .interbyte_timeout = 6,
+  .idle_cooldown_base = 10,
+  .collision_cooldown_base = 43,
+  .cooldown_step = 2
+};
+
+TEST_GROUP(tiny_gea2_backoff)
+{
+  tiny_gea2_backoff_t self;
+
+  void setup()
+  {
+    tiny_gea2_backoff_init(&self, 12345, 2, 2);
+  }
+
+  tiny_timer_ticks_t cooldown(tiny_gea2_interface_cooldown_t cooldown, uint8_t attempt, bool priority)
+  {
+    tiny_gea2_interface_cooldown_args_t args = {
+      .timing = &timing,
+      .cooldown = cooldown,
+      .address = address,
+      .attempt = attempt,
+      .priority = priority
+    };
+
+    return tiny_gea2_backoff_cooldown(&self, &args);
+  }
+};
+
+TEST(tiny_gea2_backoff, should_use_the_address_to_choose_the_idle_cooldown)
+{
+  CHECK_EQUAL(10 + address_slots * 2, cooldown(tiny_gea2_interface_cooldown_idle, 0, false));
+}
+
+TEST(tiny_gea2_backoff, should_skip_the_address_slots_in_the_idle_cooldown_for_priority_packets)
+{
+  CHECK_EQUAL(10, cooldown(tiny_gea2_interface_cooldown_idle, 0, true));
+}
+
+TEST(tiny_gea2_backoff, should_choose_one_of_32_random_slots_after_the_first_collision)
+{
+  for(uint8_t i = 0; i < 100; i++) {
+    tiny_timer_ticks_t ticks = cooldown(tiny_gea2_interface_cooldown_collision, 1, false);
+    CHECK(ticks >= 43 + address_slots * 2);
+    CHECK(ticks <= 43 + (address_slots + 31) * 2);
+    CHECK_EQUAL(1, ticks % 2);
+  }
+}
+
+TEST(tiny_gea2_backoff, should_double_the_random_slots_for_each_attempt_up_to_the_maximum_exponent)
+{
+  tiny_timer_ticks_t longest = 0;
+
+  for(uint16_t i = 0; i < 500; i++) {
+    tiny_timer_ticks_t ticks = cooldown(tiny_gea2_interface_cooldown_collision, 5, false);
+    CHECK(ticks <= 43 + (address_slots + 127) * 2);
+
+    if(ticks > longest) {
+      longest = ticks;
+    }
+  }
+
+  CHECK(longest > 43 + (address_slots + 63) * 2);
+}
+
+TEST(tiny_gea2_backoff, should_clamp_the_maximum_exponent)
+{
+  tiny_gea2_backoff_init(&self, 12345, 255, 2);
+  CHECK_EQUAL(10, self.max_exponent);
+
+  for(uint8_t i = 0; i < 100; i++) {
+    tiny_timer_ticks_t ticks = cooldown(tiny_gea2_interface_cooldown_collision, 255, false);
+    CHECK(ticks <= 43 + (address_slots + 32767) * 2);
+  }
+}
+
+TEST(tiny_gea2_backoff, should_saturate_cooldowns_that_do_not_fit_in_the_timer_ticks)
+{
+  tiny_gea2_interface_timing_t long_steps = timing;
+  long_steps.cooldown_step = (tiny_timer_ticks_t)-1 / 4;
+
+  tiny_gea2_interface_cooldown_args_t args = {
+    .timing = &long_steps,
+    .cooldown = tiny_gea2_interface_cooldown_collision,
+    .address = address,
+    .attempt = 1,
+    .priority = false
+  };
+
+  CHECK_EQUAL((tiny_timer_ticks_t)-1, tiny_gea2_backoff_cooldown(&self, &args));
+
+  args.cooldown = tiny_gea2_interface_cooldown_idle;
+  CHECK_EQUAL((tiny_timer_ticks_t)-1, tiny_gea2_backoff_cooldown(&self, &args));
+}
+
+TEST(tiny_gea2_backoff, should_shorten_the_collision_cooldown_for_priority_packets)
+{
+  tiny_timer_ticks_t ticks = cooldown(tiny_gea2_interface_cooldown_collision, 1, true);
+
+  CHECK(ticks >= 10);
+  CHECK(ticks <= 10 + 31 * 2);
+}
+
+TEST(tiny_gea2_backoff, should_stop_shortening_cooldowns_after_the_fairness_limit)
+{
+  CHECK_EQUAL(10, cooldown(tiny_gea2_interface_cooldown_idle, 0, true));
+  CHECK_EQUAL(10, cooldown(tiny_gea2_interface_cooldown_idle, 0, true));
+  CHECK_EQUAL(10 + address_slots * 2, cooldown(tiny_gea2_interface_cooldown_idle, 0, true));
+  CHECK_EQUAL(10, cooldown(tiny_gea2_interface_cooldown_idle, 0, true));
+}
+
+TEST(tiny_gea2_backoff, should_choose_different_slots_for_nodes_with_different_seeds)
+{
+  tiny_gea2_backoff_t other;
+  tiny_gea2_backoff_init(&other, 54321, 2, 2);
+
+  tiny_gea2_interface_cooldown_args_t args = {
+    .timing = &timing,
+    .cooldown = tiny_gea2_interface_cooldown_collision,
+    .address = address,
+    .attempt = 1,
+    .priority = false
+  };
+
+  uint8_t same = 0;
+  for(uint8_t i = 0; i < 20; i++) {
+    if(tiny_gea2_backoff_cooldown(&self, &args) == tiny_gea2_backoff_cooldown(&other, &args)) {
+      same++;
+    }
+  }
+
+  CHECK(same < 5);
+}
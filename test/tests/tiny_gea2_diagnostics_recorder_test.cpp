@@ -0,0 +1,126 @@
+/*!
+ * @file
+ * @brief
+ */
+
+extern "C" {
+#include <string.h>
+#include "tiny_gea2_diagnostics_recorder.h"
+#include "tiny_gea_constants.h"
+}
+
+#include "CppUTest/TestHarness.h"
+#include "double/tiny_time_source_double.hpp"
+#include "double/tiny_uart_double.hpp"
+
+enum {
+  address = 0xAD,
+  entry_count = 3,
+  interbyte_timeout_msec = 6
+};
+
+TEST_GROUP(tiny_gea2_diagnostics_recorder)
+{
+  tiny_gea2_diagnostics_recorder_t self;
+  tiny_gea2_interface_diagnostics_event_args_t entries[entry_count];
+
+  tiny_gea2_interface_t gea2_interface;
+  tiny_uart_double_t uart;
+  tiny_time_source_double_t time_source;
+  tiny_event_t msec_interrupt;
+  uint8_t receive_buffer[9];
+  uint8_t send_queue_buffer[20];
+
+  void setup()
+  {
+    tiny_event_init(&msec_interrupt);
+    tiny_uart_double_init(&uart);
+    tiny_time_source_double_init(&time_source);
+
+    tiny_gea2_interface_init(
+      &gea2_interface,
+      &uart.interface,
+      &time_source.interface,
+      &msec_interrupt.interface,
+      address,
+      send_queue_buffer,
+      sizeof(send_queue_buffer),
+      receive_buffer,
+      sizeof(receive_buffer),
+      false,
+      2);
+
+    tiny_gea2_diagnostics_recorder_init(&self, &gea2_interface, entries, entry_count);
+  }
+
+  void after(tiny_time_source_ticks_t ticks)
+  {
+    for(tiny_time_source_ticks_t i = 0; i < ticks; i++) {
+      tiny_time_source_double_tick(&time_source, 1);
+      tiny_event_publish(&msec_interrupt, NULL);
+    }
+  }
+
+  void after_an_interbyte_timeout_at(tiny_time_source_ticks_t ticks)
+  {
+    after(ticks - interbyte_timeout_msec - time_source.ticks);
+    tiny_uart_double_trigger_receive(&uart, tiny_gea_stx);
+    after(interbyte_timeout_msec);
+  }
+
+  void entry_should_have_timestamp(uint16_t index, tiny_time_source_ticks_t timestamp)
+  {
+    const tiny_gea2_interface_diagnostics_event_args_t* entry = tiny_gea2_diagnostics_recorder_entry(&self, index);
+    CHECK(entry != NULL);
+    CHECK_EQUAL(tiny_gea2_interface_diagnostics_event_interbyte_timeout, entry->type);
+    CHECK_EQUAL(timestamp, entry->timestamp);
+  }
+};
+
+TEST(tiny_gea2_diagnostics_recorder, should_start_empty)
+{
+  CHECK_EQUAL(0, tiny_gea2_diagnostics_recorder_count(&self));
+  POINTERS_EQUAL(NULL, tiny_gea2_diagnostics_recorder_entry(&self, 0));
+}
+
+TEST(tiny_gea2_diagnostics_recorder, should_record_events_oldest_first)
+{
+  after_an_interbyte_timeout_at(6);
+  after_an_interbyte_timeout_at(100);
+
+  CHECK_EQUAL(2, tiny_gea2_diagnostics_recorder_count(&self));
+  entry_should_have_timestamp(0, 6);
+  entry_should_have_timestamp(1, 100);
+}
+
+TEST(tiny_gea2_diagnostics_recorder, should_overwrite_the_oldest_event_when_full)
+{
+  after_an_interbyte_timeout_at(6);
+  after_an_interbyte_timeout_at(100);
+  after_an_interbyte_timeout_at(200);
+  after_an_interbyte_timeout_at(300);
+
+  CHECK_EQUAL(entry_count, tiny_gea2_diagnostics_recorder_count(&self));
+  entry_should_have_timestamp(0, 100);
+  entry_should_have_timestamp(1, 200);
+  entry_should_have_timestamp(2, 300);
+}
+
+TEST(tiny_gea2_diagnostics_recorder, should_record_nothing_without_storage)
+{
+  tiny_gea2_diagnostics_recorder_t empty;
+  tiny_gea2_diagnostics_recorder_init(&empty, &gea2_interface, entries, 0);
+
+  after_an_interbyte_timeout_at(6);
+
+  CHECK_EQUAL(0, tiny_gea2_diagnostics_recorder_count(&empty));
+  POINTERS_EQUAL(NULL, tiny_gea2_diagnostics_recorder_entry(&empty, 0));
+}
+
+TEST(tiny_gea2_diagnostics_recorder, should_discard_events_when_cleared)
+{
+  after_an_interbyte_timeout_at(6);
+  tiny_gea2_diagnostics_recorder_clear(&self);
+
+  CHECK_EQUAL(0, tiny_gea2_diagnostics_recorder_count(&self));
+}
@@ -18,7 +18,9 @@ enum {
   send_retries = 2,
   client_address = 0xA5,
   request_retries = 3,
-  request_timeout = 500
+  request_timeout = 500,
+  priority_burst_limit = 2,
+  address_run_limit = 2
 };
 
 #define request_id(_x) _x
@@ -32,11 +34,15 @@ enum {
 
 static const tiny_gea2_erd_client_configuration_t configuration = {
   .request_timeout = request_timeout,
-  .request_retries = request_retries
+  .request_retries = request_retries,
+  .priority_burst_limit = priority_burst_limit,
+  .address_run_limit = 0
 };
 
 static tiny_gea2_erd_client_request_id_t last_request_id;
 static size_t expected_data_size;
+static uintptr_t write_completed_stack_depth_min;
+static uintptr_t write_completed_stack_depth_max;
 
 TEST_GROUP(tiny_gea2_erd_client)
 {
@@ -44,9 +50,12 @@ TEST_GROUP(tiny_gea2_erd_client)
 
   tiny_event_subscription_t activitySubscription;
   tiny_event_subscription_t request_again_on_request_complete_or_failedSubscription;
+  tiny_event_subscription_t cancel_on_first_write_completedSubscription;
   tiny_timer_group_double_t timer_group;
+  tiny_gea2_erd_client_configuration_t client_configuration;
   tiny_gea_interface_double_t gea2_interface;
-  uint8_t queue_buffer[25];
+  uint8_t queue_buffer[49];
+  uint8_t large_queue_buffer[512];
 
   static void on_activity(void*, const void* _args)
   {
@@ -129,6 +138,30 @@ TEST_GROUP(tiny_gea2_erd_client)
     }
   }
 
+  // Cancels the write that just completed, which is no longer queued, and the last queued write
+  static void cancel_on_first_write_completed(void* context, const void* _args)
+  {
+    reinterpret(self, context, i_tiny_gea2_erd_client_t*);
+    reinterpret(args, _args, const tiny_gea2_erd_client_on_activity_args_t*);
+    uint8_t stack_marker = 0;
+    uintptr_t stack_depth = (uintptr_t)&stack_marker;
+
+    if(args->type != tiny_gea2_erd_client_activity_type_write_completed) {
+      return;
+    }
+
+    if(write_completed_stack_depth_min == 0) {
+      write_completed_stack_depth_min = stack_depth;
+      write_completed_stack_depth_max = stack_depth;
+
+      CHECK_FALSE(tiny_gea2_erd_client_cancel(self, args->write_completed.request_id));
+      CHECK_TRUE(tiny_gea2_erd_client_cancel(self, last_request_id));
+    }
+
+    write_completed_stack_depth_min = stack_depth < write_completed_stack_depth_min ? stack_depth : write_completed_stack_depth_min;
+    write_completed_stack_depth_max = stack_depth > write_completed_stack_depth_max ? stack_depth : write_completed_stack_depth_max;
+  }
+
   static void request_again_on_request_complete_or_failed(void* context, const void* _args)
   {
     reinterpret(self, context, i_tiny_gea2_erd_client_t*);
@@ -159,6 +192,7 @@ TEST_GROUP(tiny_gea2_erd_client)
     tiny_timer_group_double_init(&timer_group);
 
     memset(&self, 0xA5, sizeof(self));
+    client_configuration = configuration;
 
     tiny_gea2_erd_client_init(
       &self,
@@ -166,12 +200,39 @@ TEST_GROUP(tiny_gea2_erd_client)
       &gea2_interface.interface,
       queue_buffer,
       sizeof(queue_buffer),
-      &configuration);
+      &client_configuration);
 
     tiny_event_subscription_init(&activitySubscription, NULL, on_activity);
     tiny_event_subscribe(tiny_gea2_erd_client_on_activity(&self.interface), &activitySubscription);
 
     tiny_event_subscription_init(&request_again_on_request_complete_or_failedSubscription, &self, request_again_on_request_complete_or_failed);
+    tiny_event_subscription_init(&cancel_on_first_write_completedSubscription, &self, cancel_on_first_write_completed);
+
+    write_completed_stack_depth_min = 0;
+    write_completed_stack_depth_max = 0;
+  }
+
+  void given_that_requests_are_grouped_by_address()
+  {
+    client_configuration.address_run_limit = address_run_limit;
+  }
+
+  void given_that_the_client_has_a_large_request_queue()
+  {
+    tiny_gea2_erd_client_init(
+      &self,
+      &timer_group.timer_group,
+      &gea2_interface.interface,
+      large_queue_buffer,
+      sizeof(large_queue_buffer),
+      &client_configuration);
+
+    tiny_event_subscribe(tiny_gea2_erd_client_on_activity(&self.interface), &activitySubscription);
+  }
+
+  void given_that_the_client_will_cancel_on_the_first_write_completed()
+  {
+    tiny_event_subscribe(tiny_gea2_erd_client_on_activity(&self.interface), &cancel_on_first_write_completedSubscription);
   }
 
   void given_that_the_client_will_request_again_on_complete_or_failed()
@@ -392,6 +453,52 @@ TEST_GROUP(tiny_gea2_erd_client)
     CHECK(success);
   }
 
+  void after_a_read_is_requested_with_a_deadline(uint8_t address, tiny_erd_t erd, tiny_time_source_ticks_t deadline)
+  {
+    tiny_gea2_erd_client_request_options_t options = { deadline, 0, false };
+    bool success = tiny_gea2_erd_client_read_with_options(&self.interface, &last_request_id, address, erd, &options);
+    CHECK(success);
+  }
+
+  void after_a_write_is_requested_with_a_deadline(uint8_t address, tiny_erd_t erd, uint8_t data, tiny_time_source_ticks_t deadline)
+  {
+    tiny_gea2_erd_client_request_options_t options = { deadline, 0, false };
+    bool success = tiny_gea2_erd_client_write_with_options(&self.interface, &last_request_id, address, erd, &data, sizeof(data), &options);
+    CHECK(success);
+  }
+
+  void after_a_read_is_requested_with_priority(uint8_t address, tiny_erd_t erd, uint8_t priority)
+  {
+    tiny_gea2_erd_client_request_options_t options = { 0, priority, false };
+    bool success = tiny_gea2_erd_client_read_with_options(&self.interface, &last_request_id, address, erd, &options);
+    CHECK(success);
+  }
+
+  void after_a_write_is_requested_with_priority(uint8_t address, tiny_erd_t erd, uint8_t data, uint8_t priority)
+  {
+    tiny_gea2_erd_client_request_options_t options = { 0, priority, false };
+    bool success = tiny_gea2_erd_client_write_with_options(&self.interface, &last_request_id, address, erd, &data, sizeof(data), &options);
+    CHECK(success);
+  }
+
+  void after_an_unacknowledged_write_is_requested(uint8_t address, tiny_erd_t erd, uint8_t data)
+  {
+    tiny_gea2_erd_client_request_options_t options = { 0, 0, true };
+    bool success = tiny_gea2_erd_client_write_with_options(&self.interface, &last_request_id, address, erd, &data, sizeof(data), &options);
+    CHECK(success);
+  }
+
+  void after_the_request_is_cancelled(tiny_gea2_erd_client_request_id_t request_id)
+  {
+    bool success = tiny_gea2_erd_client_cancel(&self.interface, request_id);
+    CHECK(success);
+  }
+
+  void should_fail_to_cancel_the_request(tiny_gea2_erd_client_request_id_t request_id)
+  {
+    CHECK_FALSE(tiny_gea2_erd_client_cancel(&self.interface, request_id));
+  }
+
   void should_publish_read_completed(uint8_t address, tiny_erd_t erd, uint8_t data)
   {
     expected_data_size = sizeof(data);
@@ -879,6 +986,22 @@ TEST(tiny_gea2_erd_client, should_allow_a_new_write_request_in_write_request_fai
   after(request_timeout);
 }
 
+TEST(tiny_gea2_erd_client, should_provide_request_ids_wider_than_a_byte)
+{
+  for(uint16_t i = 0; i < 256; i++) {
+    a_read_request_should_be_sent(address(0x54), erd(0x1234));
+    after_a_read_is_requested(address(0x54), erd(0x1234));
+    with_an_expected_request_id(i);
+
+    should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(i));
+    after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+  }
+
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  with_an_expected_request_id(256);
+}
+
 TEST(tiny_gea2_erd_client, should_provide_request_ids_for_read_requests)
 {
   a_read_request_should_be_sent(address(0x54), erd(0x1234));
@@ -982,3 +1105,257 @@ TEST(tiny_gea2_erd_client, should_provide_the_same_request_id_for_duplicate_writ
   after_a_write_is_requested(address(0x56), erd(0x1234), (uint8_t)7);
   with_an_expected_request_id(2);
 }
+
+TEST(tiny_gea2_erd_client, should_fail_a_queued_request_whose_deadline_expires_before_it_is_sent)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_a_deadline(address(0x56), erd(0x5678), 100);
+  after_a_write_is_requested_with_a_deadline(address(0x56), erd(0xABCD), (uint8_t)42, 100);
+
+  nothing_should_happen();
+  after(100);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then should_publish_read_failed(address(0x56), erd(0x5678), request_id(1), tiny_gea2_erd_client_read_failure_reason_deadline_expired);
+  and_then should_publish_write_failed(address(0x56), erd(0xABCD), (uint8_t)42, request_id(2), tiny_gea2_erd_client_write_failure_reason_deadline_expired);
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+}
+
+TEST(tiny_gea2_erd_client, should_not_merge_a_request_into_a_queued_duplicate_with_different_options)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_a_deadline(address(0x56), erd(0x5678), 100);
+  after_a_read_is_requested(address(0x56), erd(0x5678));
+  with_an_expected_request_id(2);
+
+  nothing_should_happen();
+  after(100);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then should_publish_read_failed(address(0x56), erd(0x5678), request_id(1), tiny_gea2_erd_client_read_failure_reason_deadline_expired);
+  and_then a_read_request_should_be_sent(address(0x56), erd(0x5678));
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+}
+
+TEST(tiny_gea2_erd_client, should_fail_an_in_flight_request_instead_of_retrying_once_its_deadline_expires)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_a_deadline(address(0x54), erd(0x1234), request_timeout + 1);
+
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after(request_timeout);
+
+  should_publish_read_failed(address(0x54), erd(0x1234), request_id(0), tiny_gea2_erd_client_read_failure_reason_deadline_expired);
+  after(request_timeout);
+
+  nothing_should_happen();
+  after(request_timeout * 5);
+}
+
+TEST(tiny_gea2_erd_client, should_not_send_a_cancelled_request)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_write_is_requested(address(0x56), erd(0x5678), (uint8_t)21);
+  after_the_request_is_cancelled(request_id(1));
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+
+  nothing_should_happen();
+  after(request_timeout * 5);
+}
+
+TEST(tiny_gea2_erd_client, should_ignore_responses_to_a_cancelled_in_flight_request)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+
+  after_a_read_is_requested(address(0x54), erd(0x5678));
+  after_the_request_is_cancelled(request_id(0));
+
+  a_read_request_should_be_sent(address(0x54), erd(0x5678));
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_fail_to_cancel_the_request(request_id(0));
+}
+
+TEST(tiny_gea2_erd_client, should_not_complete_the_next_request_for_the_same_erd_with_a_late_response_to_a_cancelled_request)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x1234), 1);
+  after_the_request_is_cancelled(request_id(0));
+
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)45, request_id(1));
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)45);
+}
+
+TEST(tiny_gea2_erd_client, should_send_the_next_request_when_a_cancelled_in_flight_request_times_out)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x56), erd(0x5678));
+  after_the_request_is_cancelled(request_id(0));
+
+  nothing_should_happen();
+  after(request_timeout - 1);
+
+  a_read_request_should_be_sent(address(0x56), erd(0x5678));
+  after(1);
+}
+
+TEST(tiny_gea2_erd_client, should_send_higher_priority_requests_first)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x5678), 0);
+  after_a_write_is_requested_with_priority(address(0x56), erd(0xABCD), (uint8_t)42, 1);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then a_write_request_should_be_sent(address(0x56), erd(0xABCD), (uint8_t)42);
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_publish_write_completed(address(0x56), erd(0xABCD), (uint8_t)42, request_id(2));
+  and_then a_read_request_should_be_sent(address(0x54), erd(0x5678));
+  after_a_write_response_is_received(address(0x56), erd(0xABCD));
+}
+
+TEST(tiny_gea2_erd_client, should_not_send_a_higher_priority_request_ahead_of_an_older_write_to_the_same_erd)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_write_is_requested_with_priority(address(0x56), erd(0xABCD), (uint8_t)42, 0);
+  after_a_read_is_requested_with_priority(address(0x56), erd(0xABCD), 1);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then a_write_request_should_be_sent(address(0x56), erd(0xABCD), (uint8_t)42);
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_publish_write_completed(address(0x56), erd(0xABCD), (uint8_t)42, request_id(1));
+  and_then a_read_request_should_be_sent(address(0x56), erd(0xABCD));
+  after_a_write_response_is_received(address(0x56), erd(0xABCD));
+}
+
+TEST(tiny_gea2_erd_client, should_only_consider_the_oldest_requests_for_sending_early)
+{
+  given_that_the_client_has_a_large_request_queue();
+
+  a_read_request_should_be_sent(address(0x54), erd(0x0000));
+  after_a_read_is_requested(address(0x54), erd(0x0000));
+
+  for(uint16_t i = 1; i <= 8; i++) {
+    after_a_read_is_requested_with_priority(address(0x54), erd(i), 0);
+  }
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x00FF), 1);
+
+  should_publish_read_completed(address(0x54), erd(0x0000), (uint8_t)123, request_id(0));
+  and_then a_read_request_should_be_sent(address(0x54), erd(0x0001));
+  after_a_read_response_is_received(address(0x54), erd(0x0000), (uint8_t)123);
+
+  should_publish_read_completed(address(0x54), erd(0x0001), (uint8_t)123, request_id(1));
+  and_then a_read_request_should_be_sent(address(0x54), erd(0x00FF));
+  after_a_read_response_is_received(address(0x54), erd(0x0001), (uint8_t)123);
+}
+
+TEST(tiny_gea2_erd_client, should_group_requests_to_the_same_address_when_enabled)
+{
+  given_that_requests_are_grouped_by_address();
+
+  a_read_request_should_be_sent(address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x56), erd(0x0002));
+  after_a_read_is_requested(address(0x54), erd(0x0003));
+
+  should_publish_read_completed(address(0x54), erd(0x0001), (uint8_t)123, request_id(0));
+  and_then a_read_request_should_be_sent(address(0x54), erd(0x0003));
+  after_a_read_response_is_received(address(0x54), erd(0x0001), (uint8_t)123);
+
+  should_publish_read_completed(address(0x54), erd(0x0003), (uint8_t)123, request_id(2));
+  and_then a_read_request_should_be_sent(address(0x56), erd(0x0002));
+  after_a_read_response_is_received(address(0x54), erd(0x0003), (uint8_t)123);
+}
+
+TEST(tiny_gea2_erd_client, should_not_send_more_than_the_run_limit_to_one_address_while_other_addresses_wait)
+{
+  given_that_requests_are_grouped_by_address();
+
+  a_read_request_should_be_sent(address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x56), erd(0x0002));
+  after_a_read_is_requested(address(0x54), erd(0x0003));
+
+  should_publish_read_completed(address(0x54), erd(0x0001), (uint8_t)123, request_id(0));
+  and_then a_read_request_should_be_sent(address(0x54), erd(0x0003));
+  after_a_read_response_is_received(address(0x54), erd(0x0001), (uint8_t)123);
+
+  after_a_read_is_requested(address(0x54), erd(0x0004));
+
+  should_publish_read_completed(address(0x54), erd(0x0003), (uint8_t)123, request_id(2));
+  and_then a_read_request_should_be_sent(address(0x56), erd(0x0002));
+  after_a_read_response_is_received(address(0x54), erd(0x0003), (uint8_t)123);
+
+  should_publish_read_completed(address(0x56), erd(0x0002), (uint8_t)123, request_id(1));
+  and_then a_read_request_should_be_sent(address(0x54), erd(0x0004));
+  after_a_read_response_is_received(address(0x56), erd(0x0002), (uint8_t)123);
+}
+
+TEST(tiny_gea2_erd_client, should_complete_an_unacknowledged_write_as_soon_as_it_is_sent)
+{
+  a_write_request_should_be_sent(address(0x54), erd(0x1234), (uint8_t)42);
+  should_publish_write_completed(address(0x54), erd(0x1234), (uint8_t)42, request_id(0));
+  after_an_unacknowledged_write_is_requested(address(0x54), erd(0x1234), (uint8_t)42);
+
+  nothing_should_happen();
+  after_a_write_response_is_received(address(0x54), erd(0x1234));
+  after(request_timeout * 5);
+}
+
+TEST(tiny_gea2_erd_client, should_send_queued_unacknowledged_writes_in_order_without_waiting_for_responses)
+{
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_an_unacknowledged_write_is_requested(address(0xFF), erd(0x5678), (uint8_t)1);
+  after_an_unacknowledged_write_is_requested(address(0xFF), erd(0x5678), (uint8_t)2);
+
+  mock().strictOrder();
+  a_write_request_should_be_sent(address(0xFF), erd(0x5678), (uint8_t)1);
+  should_publish_write_completed(address(0xFF), erd(0x5678), (uint8_t)1, request_id(1));
+  a_write_request_should_be_sent(address(0xFF), erd(0x5678), (uint8_t)2);
+  should_publish_write_completed(address(0xFF), erd(0x5678), (uint8_t)2, request_id(2));
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+}
+
+TEST(tiny_gea2_erd_client, should_complete_many_queued_unacknowledged_writes_without_nesting_when_a_handler_cancels)
+{
+  enum { write_count = 20 };
+
+  given_that_the_client_has_a_large_request_queue();
+  given_that_the_client_will_cancel_on_the_first_write_completed();
+
+  a_read_request_should_be_sent(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+
+  for(uint8_t i = 1; i <= write_count; i++) {
+    after_an_unacknowledged_write_is_requested(address(0xFF), erd(0x5678), i);
+  }
+
+  mock().strictOrder();
+  for(uint8_t i = 1; i < write_count; i++) {
+    a_write_request_should_be_sent(address(0xFF), erd(0x5678), i);
+    should_publish_write_completed(address(0xFF), erd(0x5678), i, request_id(i));
+  }
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  after_a_read_response_is_received(address(0x54), erd(0x1234), (uint8_t)123);
+
+  CHECK_EQUAL(write_completed_stack_depth_min, write_completed_stack_depth_max);
+
+  nothing_should_happen();
+  after(request_timeout * 5);
+}
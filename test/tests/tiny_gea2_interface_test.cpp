@@ -32,6 +32,8 @@ enum {
 
 };
 
+static bool last_diagnostics_event_was_broadcast;
+
 TEST_GROUP(tiny_gea2_interface)
 {
   tiny_gea2_interface_t self;
@@ -41,6 +43,7 @@ TEST_GROUP(tiny_gea2_interface)
   uint8_t send_queue_buffer[send_queue_size];
   tiny_time_source_double_t time_source;
   tiny_event_t msec_interrupt;
+  tiny_event_subscription_t diagnostics_subscription;
 
   void setup()
   {
@@ -149,6 +152,39 @@ TEST_GROUP(tiny_gea2_interface)
       .withMemoryBufferParameter("payload", packet->payload, packet->payload_length);
   }
 
+  static void diagnostics_event_raised(void*, const void* _args)
+  {
+    reinterpret(args, _args, const tiny_gea2_interface_diagnostics_event_args_t*);
+    last_diagnostics_event_was_broadcast = args->broadcast;
+    mock()
+      .actualCall("diagnostics_event")
+      .withParameter("timestamp", args->timestamp)
+      .withParameter("type", args->type)
+      .withParameter("address", args->address)
+      .withParameter("attempt", args->attempt);
+  }
+
+  void given_that_diagnostics_events_are_subscribed()
+  {
+    tiny_event_subscription_init(&diagnostics_subscription, NULL, diagnostics_event_raised);
+    tiny_event_subscribe(tiny_gea2_interface_on_diagnostics_event(&self), &diagnostics_subscription);
+    tiny_gea2_interface_enable_diagnostics(&self);
+  }
+
+  void diagnostics_event_should_be_raised(
+    tiny_time_source_ticks_t timestamp,
+    tiny_gea2_interface_diagnostics_event_type_t type,
+    uint8_t address,
+    uint8_t attempt)
+  {
+    mock()
+      .expectOneCall("diagnostics_event")
+      .withParameter("timestamp", timestamp)
+      .withParameter("type", type)
+      .withParameter("address", address)
+      .withParameter("attempt", attempt);
+  }
+
   void byte_should_be_sent(uint8_t byte)
   {
     mock().expectOneCall("send").onObject(&uart).withParameter("byte", byte);
@@ -403,6 +439,46 @@ TEST(tiny_gea2_interface, should_receive_a_packet_with_a_payload)
   after_the_interface_is_run();
 }
 
+TEST(tiny_gea2_interface, should_receive_bytes_directly_instead_of_through_the_uart_when_direct_byte_receive_is_used)
+{
+  tiny_gea2_interface_use_direct_byte_receive(&self);
+
+  nothing_should_happen();
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0x74, // crc
+    0x0D,
+    tiny_gea_etx);
+  after_the_interface_is_run();
+
+  const uint8_t bytes[] = {
+    tiny_gea_stx,
+    address, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0x74, // crc
+    0x0D,
+    tiny_gea_etx
+  };
+
+  ack_should_be_sent();
+  for(uint8_t i = 0; i < sizeof(bytes); i++) {
+    tiny_gea2_interface_byte_received(&self, bytes[i]);
+  }
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 1);
+  packet->destination = address;
+  packet->source = 0x45;
+  packet->payload[0] = 0xBF;
+  packet_should_be_received(packet);
+  after_the_interface_is_run();
+}
+
 TEST(tiny_gea2_interface, should_receive_a_packet_with_maximum_payload)
 {
   ack_should_be_sent();
@@ -432,6 +508,9 @@ TEST(tiny_gea2_interface, should_receive_a_packet_with_maximum_payload)
 
 TEST(tiny_gea2_interface, should_raise_packet_received_diagnostics_event_when_a_packet_is_received)
 {
+  given_that_diagnostics_events_are_subscribed();
+
+  diagnostics_event_should_be_raised(0, tiny_gea2_interface_diagnostics_event_packet_received, 0x45, 0);
   ack_should_be_sent();
   after_bytes_are_received_via_uart(
     tiny_gea_stx,
@@ -531,6 +610,67 @@ TEST(tiny_gea2_interface, should_drop_packets_addressed_to_other_nodes)
   after_the_interface_is_run();
 }
 
+TEST(tiny_gea2_interface, should_receive_and_acknowledge_packets_for_addresses_in_the_address_filter)
+{
+  static uint8_t address_filter[32];
+  address_filter[(address + 1) / 8] |= 1 << ((address + 1) % 8);
+  tiny_gea2_interface_set_address_filter(&self, address_filter);
+
+  ack_should_be_sent();
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address + 1, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0xEF, // crc
+    0xD1,
+    tiny_gea_etx);
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 1);
+  packet->destination = address + 1;
+  packet->source = 0x45;
+  packet->payload[0] = 0xBF;
+  packet_should_be_received(packet);
+  after_the_interface_is_run();
+}
+
+TEST(tiny_gea2_interface, should_drop_packets_for_addresses_not_in_the_address_filter_and_still_receive_the_next_packet)
+{
+  static uint8_t address_filter[32];
+  address_filter[(address + 2) / 8] |= 1 << ((address + 2) % 8);
+  tiny_gea2_interface_set_address_filter(&self, address_filter);
+
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address + 1, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0xEF, // crc
+    0xD1,
+    tiny_gea_etx);
+
+  nothing_should_happen();
+  after_the_interface_is_run();
+
+  ack_should_be_sent();
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address, // dst
+    0x07, // len
+    0x45, // src
+    0x08, // crc
+    0x8F,
+    tiny_gea_etx);
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = address;
+  packet->source = 0x45;
+  packet_should_be_received(packet);
+  after_the_interface_is_run();
+}
+
 TEST(tiny_gea2_interface, should_receive_multiple_packets)
 {
   {
@@ -744,6 +884,60 @@ TEST(tiny_gea2_interface, should_reject_packets_that_violate_the_interbyte_timeo
   after_the_interface_is_run();
 }
 
+TEST(tiny_gea2_interface, should_measure_the_interbyte_timeout_from_the_most_recent_byte)
+{
+  const uint8_t bytes[] = {
+    tiny_gea_stx,
+    address, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0x74, // crc
+    0x0D
+  };
+
+  for(uint8_t i = 0; i < sizeof(bytes); i++) {
+    when_byte_is_received(bytes[i]);
+    after(gea2_interbyte_timeout_msec - 1);
+  }
+
+  ack_should_be_sent();
+  after_bytes_are_received_via_uart(tiny_gea_etx);
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 1);
+  packet->destination = address;
+  packet->source = 0x45;
+  packet->payload[0] = 0xBF;
+  packet_should_be_received(packet);
+  after_the_interface_is_run();
+}
+
+TEST(tiny_gea2_interface, should_reject_packets_when_the_interbyte_timeout_expires_after_a_series_of_timely_bytes)
+{
+  const uint8_t bytes[] = {
+    tiny_gea_stx,
+    address, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0x74, // crc
+  };
+
+  for(uint8_t i = 0; i < sizeof(bytes); i++) {
+    when_byte_is_received(bytes[i]);
+    after(gea2_interbyte_timeout_msec - 1);
+  }
+
+  when_byte_is_received(0x0D);
+  after(gea2_interbyte_timeout_msec);
+
+  nothing_should_happen();
+  after_bytes_are_received_via_uart(tiny_gea_etx);
+
+  nothing_should_happen();
+  after_the_interface_is_run();
+}
+
 TEST(tiny_gea2_interface, should_reject_packets_that_violate_the_interbyte_timeout_after_stx)
 {
   after_bytes_are_received_via_uart(tiny_gea_stx);
@@ -866,6 +1060,7 @@ TEST(tiny_gea2_interface, should_send_a_packet_with_max_payload_given_send_buffe
 
 TEST(tiny_gea2_interface, should_raise_a_packet_sent_event_when_a_packet_is_sent)
 {
+  given_that_diagnostics_events_are_subscribed();
   given_uart_echoing_is_enabled();
 
   should_send_bytes_via_uart(
@@ -882,6 +1077,9 @@ TEST(tiny_gea2_interface, should_raise_a_packet_sent_event_when_a_packet_is_sent
   packet->destination = 0x45;
   packet->payload[0] = 0xD5;
   when_packet_is_sent(packet);
+
+  diagnostics_event_should_be_raised(0, tiny_gea2_interface_diagnostics_event_packet_sent, 0x45, 0);
+  after_bytes_are_received_via_uart(tiny_gea_ack);
 }
 
 TEST(tiny_gea2_interface, should_not_send_a_packet_that_is_too_large_for_the_send_queue)
@@ -1076,11 +1274,14 @@ TEST(tiny_gea2_interface, should_retry_sending_when_the_reflection_timeout_viola
 
 TEST(tiny_gea2_interface, should_raise_reflection_timed_out_diagnostics_event_when_a_reflection_timeout_retry_sending_when_the_reflection_timeout_violation_occurs_and_stop_after_retries_are_exhausted)
 {
+  given_that_diagnostics_events_are_subscribed();
+
   should_send_bytes_via_uart(tiny_gea_stx);
   tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
   packet->destination = 0x45;
   when_packet_is_sent(packet);
 
+  diagnostics_event_should_be_raised(gea2_reflection_timeout_msec, tiny_gea2_interface_diagnostics_event_reflection_timeout, 0x45, 0);
   after(gea2_reflection_timeout_msec);
 }
 
@@ -1418,3 +1619,445 @@ TEST(tiny_gea2_interface, should_receive_packets_addressed_to_other_nodes_when_i
   packet_should_be_received(packet);
   after_the_interface_is_run();
 }
+
+TEST(tiny_gea2_interface, should_send_priority_packets_before_queued_packets)
+{
+  static uint8_t priority_send_queue[10];
+  static uint8_t priority_commands[32];
+  priority_commands[0xE7 / 8] = 1 << (0xE7 % 8);
+  tiny_gea2_interface_use_priority_send_queue(&self, priority_send_queue, sizeof(priority_send_queue), priority_commands);
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 1);
+  packet->destination = 0xFF;
+  packet->payload[0] = 0xD5;
+
+  tiny_gea_STATIC_ALLOC_PACKET(another_packet, 1);
+  another_packet->destination = 0xFF;
+  another_packet->payload[0] = 0x42;
+
+  tiny_gea_STATIC_ALLOC_PACKET(priority_packet, 1);
+  priority_packet->destination = 0xFF;
+  priority_packet->payload[0] = 0xE7;
+
+  given_uart_echoing_is_enabled();
+
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0xFF, // dst
+    0x08, // len
+    address, // src
+    0xD5, // payload
+    0xB8, // crc
+    0xA9,
+    tiny_gea_etx);
+  tiny_gea_interface_send(&self.interface, packet->destination, packet->payload_length, packet, send_callback);
+  tiny_gea_interface_send(&self.interface, another_packet->destination, another_packet->payload_length, another_packet, send_callback);
+  tiny_gea_interface_send(&self.interface, priority_packet->destination, priority_packet->payload_length, priority_packet, send_callback);
+  after_msec_interrupt_fires();
+
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0xFF, // dst
+    0x08, // len
+    address, // src
+    0xE7, // payload
+    0xAE, // crc
+    0xB8,
+    tiny_gea_etx);
+  after(100);
+  after_the_interface_is_run();
+
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0xFF, // dst
+    0x08, // len
+    address, // src
+    0x42, // payload
+    0x4B, // crc
+    0xF7,
+    tiny_gea_etx);
+  after(100);
+  after_the_interface_is_run();
+  after(100);
+  after_the_interface_is_run();
+}
+
+TEST(tiny_gea2_interface, should_send_a_packet_for_another_destination_before_retrying_when_destination_rotation_is_enabled)
+{
+  tiny_gea2_interface_rotate_destinations_after_failures(&self, true);
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = 0x45;
+
+  tiny_gea_STATIC_ALLOC_PACKET(another_packet, 1);
+  another_packet->destination = 0xFF;
+  another_packet->payload[0] = 0xD5;
+
+  given_uart_echoing_is_enabled();
+
+  the_packet_should_be_resent();
+  when_packets_are_sent(packet, another_packet);
+
+  nothing_should_happen();
+  after(tiny_gea_ack_timeout_msec);
+  after_the_interface_is_run();
+
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0xFF, // dst
+    0x08, // len
+    address, // src
+    0xD5, // payload
+    0xB8, // crc
+    0xA9,
+    tiny_gea_etx);
+  after(100);
+  after_the_interface_is_run();
+
+  the_packet_should_be_resent();
+  after(1);
+}
+
+TEST(tiny_gea2_interface, should_retry_a_packet_before_sending_packets_for_other_destinations_by_default)
+{
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = 0x45;
+
+  tiny_gea_STATIC_ALLOC_PACKET(another_packet, 1);
+  another_packet->destination = 0xFF;
+  another_packet->payload[0] = 0xD5;
+
+  given_uart_echoing_is_enabled();
+
+  the_packet_should_be_resent();
+  when_packets_are_sent(packet, another_packet);
+
+  nothing_should_happen();
+  after(tiny_gea_ack_timeout_msec);
+  after_the_interface_is_run();
+
+  the_packet_should_be_resent();
+  after(100);
+  after_the_interface_is_run();
+}
+
+TEST(tiny_gea2_interface, should_have_no_deadline_when_tickless_and_idle)
+{
+  tiny_gea2_interface_init(
+    &self,
+    &uart.interface,
+    &time_source.interface,
+    NULL,
+    address,
+    send_queue_buffer,
+    sizeof(send_queue_buffer),
+    receive_buffer,
+    sizeof(receive_buffer),
+    false,
+    default_retries);
+
+  CHECK_EQUAL(tiny_gea2_interface_no_deadline, tiny_gea2_interface_ticks_until_next_deadline(&self));
+}
+
+TEST(tiny_gea2_interface, should_send_when_tickless_and_serviced_and_report_the_ack_timeout_as_the_next_deadline)
+{
+  tiny_gea2_interface_init(
+    &self,
+    &uart.interface,
+    &time_source.interface,
+    NULL,
+    address,
+    send_queue_buffer,
+    sizeof(send_queue_buffer),
+    receive_buffer,
+    sizeof(receive_buffer),
+    false,
+    default_retries);
+
+  given_uart_echoing_is_enabled();
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = 0x45;
+  tiny_gea_interface_send(&self.interface, packet->destination, packet->payload_length, packet, send_callback);
+
+  CHECK_EQUAL(0, tiny_gea2_interface_ticks_until_next_deadline(&self));
+
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0x45, // dst
+    0x07, // len
+    address, // src
+    0x7D, // crc
+    0x39,
+    tiny_gea_etx);
+  CHECK_EQUAL(tiny_gea_ack_timeout_msec, tiny_gea2_interface_service(&self));
+  CHECK_EQUAL(tiny_gea_ack_timeout_msec, tiny_gea2_interface_ticks_until_next_deadline(&self));
+}
+
+TEST(tiny_gea2_interface, should_derive_default_timing_for_19200_baud_with_a_1_msec_tick)
+{
+  tiny_gea2_interface_timing_t timing;
+  tiny_gea2_interface_timing_init(&timing, 19200, 1000);
+
+  CHECK_EQUAL(gea2_reflection_timeout_msec, timing.reflection_timeout);
+  CHECK_EQUAL(tiny_gea_ack_timeout_msec, timing.ack_timeout);
+  CHECK_EQUAL(gea2_interbyte_timeout_msec, timing.interbyte_timeout);
+  CHECK_EQUAL(10, timing.idle_cooldown_base);
+  CHECK_EQUAL(43, timing.collision_cooldown_base);
+  CHECK_EQUAL(1, timing.cooldown_step);
+}
+
+TEST(tiny_gea2_interface, should_scale_timing_to_the_baud_rate_and_tick_rate_rounding_up)
+{
+  tiny_gea2_interface_timing_t timing;
+  tiny_gea2_interface_timing_init(&timing, 115200, 10000);
+
+  CHECK_EQUAL(10, timing.reflection_timeout);
+  CHECK_EQUAL(14, timing.ack_timeout);
+  CHECK_EQUAL(10, timing.interbyte_timeout);
+  CHECK_EQUAL(17, timing.idle_cooldown_base);
+  CHECK_EQUAL(72, timing.collision_cooldown_base);
+  CHECK_EQUAL(2, timing.cooldown_step);
+}
+
+TEST(tiny_gea2_interface, should_use_custom_timing_for_ack_timeouts_and_collision_cooldowns)
+{
+  static const tiny_gea2_interface_timing_t timing = {
+    .reflection_timeout = 2,
+    .ack_timeout = 3,
+    .interbyte_timeout = 2,
+    .idle_cooldown_base = 4,
+    .collision_cooldown_base = 5,
+    .cooldown_step = 1
+  };
+  tiny_gea2_interface_set_timing(&self, &timing);
+
+  given_uart_echoing_is_enabled();
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0x45, // dst
+    0x07, // len
+    address, // src
+    0x7D, // crc
+    0x39,
+    tiny_gea_etx);
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = 0x45;
+  when_packet_is_sent(packet);
+
+  nothing_should_happen();
+  after(3);
+
+  tiny_time_source_ticks_t collision_timeout = 5 + (address & 0x1F) + ((time_source.ticks ^ address) & 0x1F);
+  after(collision_timeout - 1);
+
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0x45, // dst
+    0x07, // len
+    address, // src
+    0x7D, // crc
+    0x39,
+    tiny_gea_etx);
+  after(1);
+}
+
+TEST(tiny_gea2_interface, should_keep_the_send_window_full_while_checking_reflections_in_order)
+{
+  tiny_gea2_interface_set_send_window(&self, 4);
+
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0x45, // dst
+    0x07, // len
+    address); // src
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = 0x45;
+  when_packet_is_sent(packet);
+
+  should_send_bytes_via_uart(0x7D); // crc
+  after_bytes_are_received_via_uart(tiny_gea_stx);
+
+  should_send_bytes_via_uart(0x39);
+  after_bytes_are_received_via_uart(0x45);
+
+  should_send_bytes_via_uart(tiny_gea_etx);
+  after_bytes_are_received_via_uart(0x07);
+
+  nothing_should_happen();
+  after_bytes_are_received_via_uart(address, 0x7D, 0x39, tiny_gea_etx);
+  after_bytes_are_received_via_uart(tiny_gea_ack);
+  after_the_interface_is_run();
+
+  should_be_able_to_send_a_packet_after_idle_cooldown();
+}
+
+TEST(tiny_gea2_interface, should_abort_a_windowed_send_when_a_reflection_does_not_match)
+{
+  tiny_gea2_interface_set_send_window(&self, 4);
+
+  should_send_bytes_via_uart(
+    tiny_gea_stx,
+    0x45, // dst
+    0x07, // len
+    address); // src
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = 0x45;
+  when_packet_is_sent(packet);
+
+  should_send_bytes_via_uart(0x7D); // crc
+  after_bytes_are_received_via_uart(tiny_gea_stx);
+
+  nothing_should_happen();
+  after_bytes_are_received_via_uart(0x12);
+
+  should_be_able_to_send_a_packet_after_collision_cooldown();
+}
+
+static tiny_timer_ticks_t cooldown_policy(void*, const tiny_gea2_interface_cooldown_args_t* args)
+{
+  mock()
+    .actualCall("cooldown_policy")
+    .withParameter("cooldown", args->cooldown)
+    .withParameter("address", args->address)
+    .withParameter("attempt", args->attempt)
+    .withParameter("priority", args->priority);
+
+  return 5;
+}
+
+TEST(tiny_gea2_interface, should_use_the_cooldown_policy_for_collision_cooldowns)
+{
+  tiny_gea2_interface_set_cooldown_policy(&self, NULL, cooldown_policy);
+
+  mock()
+    .expectOneCall("cooldown_policy")
+    .withParameter("cooldown", tiny_gea2_interface_cooldown_collision)
+    .withParameter("address", address)
+    .withParameter("attempt", 1)
+    .withParameter("priority", false);
+  given_the_module_is_in_collision_cooldown();
+
+  nothing_should_happen();
+  after(4);
+
+  should_send_bytes_via_uart(tiny_gea_stx);
+  after(1);
+}
+
+static tiny_timer_ticks_t transmit_gate(void* context)
+{
+  mock().actualCall("transmit_gate");
+  return *(tiny_timer_ticks_t*)context;
+}
+
+TEST(tiny_gea2_interface, should_wait_until_the_transmit_gate_opens_to_send)
+{
+  tiny_timer_ticks_t ticks_until_open = 5;
+  tiny_gea2_interface_set_transmit_gate(&self, &ticks_until_open, transmit_gate);
+
+  mock().expectOneCall("transmit_gate");
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = 0x45;
+  when_packet_is_sent(packet);
+
+  nothing_should_happen();
+  after(4);
+
+  ticks_until_open = 0;
+  mock().expectOneCall("transmit_gate");
+  should_send_bytes_via_uart(tiny_gea_stx);
+  after(1);
+}
+
+TEST(tiny_gea2_interface, should_raise_collision_diagnostics_events_with_the_attempt_and_then_retries_exhausted)
+{
+  given_that_retries_have_been_set_to(1);
+  given_that_diagnostics_events_are_subscribed();
+
+  should_send_bytes_via_uart(tiny_gea_stx);
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = 0x45;
+  when_packet_is_sent(packet);
+
+  diagnostics_event_should_be_raised(0, tiny_gea2_interface_diagnostics_event_collision, 0x45, 0);
+  after_bytes_are_received_via_uart(tiny_gea_stx - 1);
+
+  should_send_bytes_via_uart(tiny_gea_stx);
+  after(collision_timeout_msec());
+
+  diagnostics_event_should_be_raised((tiny_time_source_ticks_t)time_source.ticks, tiny_gea2_interface_diagnostics_event_collision, 0x45, 1);
+  diagnostics_event_should_be_raised((tiny_time_source_ticks_t)time_source.ticks, tiny_gea2_interface_diagnostics_event_retries_exhausted, 0x45, 1);
+  after_bytes_are_received_via_uart(tiny_gea_stx - 1);
+}
+
+TEST(tiny_gea2_interface, should_raise_an_ack_timeout_diagnostics_event_when_no_ack_is_received)
+{
+  given_that_diagnostics_events_are_subscribed();
+  given_that_a_packet_has_been_sent();
+
+  diagnostics_event_should_be_raised(tiny_gea_ack_timeout_msec, tiny_gea2_interface_diagnostics_event_ack_timeout, 0x45, 0);
+  after(tiny_gea_ack_timeout_msec);
+}
+
+TEST(tiny_gea2_interface, should_raise_a_packet_dropped_diagnostics_event_when_a_packet_has_an_invalid_crc)
+{
+  given_that_diagnostics_events_are_subscribed();
+
+  diagnostics_event_should_be_raised(0, tiny_gea2_interface_diagnostics_event_packet_dropped, 0x45, 0);
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0xDE, // crc
+    0xAD,
+    tiny_gea_etx);
+}
+
+TEST(tiny_gea2_interface, should_raise_an_interbyte_timeout_diagnostics_event)
+{
+  given_that_diagnostics_events_are_subscribed();
+
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address, // dst
+    0x08); // len
+
+  diagnostics_event_should_be_raised(gea2_interbyte_timeout_msec, tiny_gea2_interface_diagnostics_event_interbyte_timeout, 0xFF, 0);
+  after(gea2_interbyte_timeout_msec);
+  CHECK_FALSE(last_diagnostics_event_was_broadcast);
+}
+
+TEST(tiny_gea2_interface, should_raise_an_interbyte_timeout_diagnostics_event_with_the_source_and_broadcast_flag_once_they_are_received)
+{
+  given_that_diagnostics_events_are_subscribed();
+
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    tiny_gea_broadcast_address, // dst
+    0x08, // len
+    0x45); // src
+
+  diagnostics_event_should_be_raised(gea2_interbyte_timeout_msec, tiny_gea2_interface_diagnostics_event_interbyte_timeout, 0x45, 0);
+  after(gea2_interbyte_timeout_msec);
+  CHECK_TRUE(last_diagnostics_event_was_broadcast);
+}
+
+TEST(tiny_gea2_interface, should_not_raise_diagnostics_events_until_diagnostics_are_enabled)
+{
+  tiny_event_subscription_init(&diagnostics_subscription, NULL, diagnostics_event_raised);
+  tiny_event_subscribe(tiny_gea2_interface_on_diagnostics_event(&self), &diagnostics_subscription);
+
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address, // dst
+    0x08); // len
+
+  nothing_should_happen();
+  after(gea2_interbyte_timeout_msec);
+}
@@ -0,0 +1,355 @@
+/*!
+ * @file
+ * @brief
+ */
+
+extern "C" {
+#include <string.h>
+#include "tiny_gea2_tdma.h"
+#include "tiny_gea_constants.h"
+#include "tiny_utils.h"
+}
+
+#include "CppUTest/TestHarness.h"
+#include "double/tiny_time_source_double.hpp"
+
+enum {
+  node_count = 3,
+  node_a = 0x10,
+  node_b = 0x20,
+  sync_node = 0x30,
+  slot_ticks = 40,
+  guard_ticks = 25,
+  frame_ticks = node_count * slot_ticks,
+  sync_timeout = 500,
+  max_starts = 20
+};
+
+static const uint8_t slot_owners[] = { sync_node, node_a, node_b };
+
+static const tiny_gea2_tdma_config_t config = {
+  .slot_owners = slot_owners,
+  .slot_count = sizeof(slot_owners),
+  .slot_ticks = slot_ticks,
+  .guard_ticks = guard_ticks,
+  .sync_address = sync_node,
+  .sync_timeout = sync_timeout
+};
+
+// A node on a simulated bus. Bytes sent by the nodes are put on the bus once per tick and every
+// node, including the senders, receives the result. Bytes sent in the same tick collide.
+typedef struct {
+  i_tiny_uart_t uart;
+  tiny_event_t on_receive;
+  tiny_event_t on_send_complete;
+  bool byte_pending;
+  uint8_t pending_byte;
+
+  tiny_gea2_interface_t gea2_interface;
+  tiny_gea2_tdma_t tdma;
+  tiny_event_subscription_t packet_received;
+  uint8_t receive_buffer[16];
+  uint8_t send_queue_buffer[64];
+  uint8_t packets_received;
+} node_t;
+
+typedef struct {
+  uint8_t address;
+  tiny_time_source_ticks_t time;
+} start_t;
+
+static void send(i_tiny_uart_t* uart, uint8_t byte)
+{
+  reinterpret(node, uart, node_t*);
+  node->byte_pending = true;
+  node->pending_byte = byte;
+}
+
+static i_tiny_event_t* on_send_complete(i_tiny_uart_t* uart)
+{
+  reinterpret(node, uart, node_t*);
+  return &node->on_send_complete.interface;
+}
+
+static i_tiny_event_t* on_receive(i_tiny_uart_t* uart)
+{
+  reinterpret(node, uart, node_t*);
+  return &node->on_receive.interface;
+}
+
+static const i_tiny_uart_api_t uart_api = { send, on_send_complete, on_receive };
+
+TEST_GROUP(tiny_gea2_tdma)
+{
+  node_t nodes[node_count];
+  tiny_time_source_double_t time_source;
+  tiny_event_t msec_interrupt;
+  start_t starts[max_starts];
+  uint8_t start_count;
+  uint16_t collisions;
+
+  static void packet_received(void* context, const void*)
+  {
+    reinterpret(node, context, node_t*);
+    node->packets_received++;
+  }
+
+  void setup()
+  {
+    tiny_event_init(&msec_interrupt);
+    tiny_time_source_double_init(&time_source);
+    start_count = 0;
+    collisions = 0;
+
+    for(uint8_t i = 0; i < node_count; i++) {
+      node_t* node = &nodes[i];
+      memset(node, 0, sizeof(*node));
+      node->uart.api = &uart_api;
+      tiny_event_init(&node->on_receive);
+      tiny_event_init(&node->on_send_complete);
+
+      tiny_gea2_interface_init(
+        &node->gea2_interface,
+        &node->uart,
+        &time_source.interface,
+        &msec_interrupt.interface,
+        slot_owners[(i + 1) % node_count],
+        node->send_queue_buffer,
+        sizeof(node->send_queue_buffer),
+        node->receive_buffer,
+        sizeof(node->receive_buffer),
+        false,
+        2);
+
+      tiny_gea2_tdma_init(&node->tdma, &node->gea2_interface, &time_source.interface, &config, NULL, NULL);
+
+      tiny_event_subscription_init(&node->packet_received, node, packet_received);
+      tiny_event_subscribe(tiny_gea_interface_on_receive(&node->gea2_interface.interface), &node->packet_received);
+    }
+  }
+
+  node_t* node(uint8_t address)
+  {
+    for(uint8_t i = 0; i < node_count; i++) {
+      if(nodes[i].gea2_interface.address == address) {
+        return &nodes[i];
+      }
+    }
+
+    return NULL;
+  }
+
+  void put_pending_bytes_on_the_bus()
+  {
+    uint8_t senders = 0;
+    uint8_t sender = 0;
+    uint8_t byte = 0xFF;
+
+    for(uint8_t i = 0; i < node_count; i++) {
+      if(nodes[i].byte_pending) {
+        nodes[i].byte_pending = false;
+        senders++;
+        sender = nodes[i].gea2_interface.address;
+        byte &= nodes[i].pending_byte;
+      }
+    }
+
+    if(senders == 0) {
+      return;
+    }
+
+    if(senders > 1) {
+      collisions++;
+    }
+    else if((byte == tiny_gea_stx) && (start_count < max_starts)) {
+      starts[start_count++] = { sender, time_source.ticks };
+    }
+
+    tiny_uart_on_receive_args_t args = { byte };
+
+    for(uint8_t i = 0; i < node_count; i++) {
+      tiny_event_publish(&nodes[i].on_receive, &args);
+    }
+  }
+
+  void after(tiny_time_source_ticks_t ticks)
+  {
+    for(tiny_time_source_ticks_t i = 0; i < ticks; i++) {
+      tiny_time_source_double_tick(&time_source, 1);
+      tiny_event_publish(&msec_interrupt, NULL);
+      put_pending_bytes_on_the_bus();
+
+      for(uint8_t j = 0; j < node_count; j++) {
+        tiny_gea2_interface_run(&nodes[j].gea2_interface);
+      }
+    }
+  }
+
+  static void send_callback(void* context, tiny_gea_packet_t* packet)
+  {
+    packet->payload[0] = *(const uint8_t*)context;
+  }
+
+  void when_a_broadcast_is_sent_by(uint8_t address)
+  {
+    uint8_t payload = 0x42;
+    tiny_gea_interface_send(&node(address)->gea2_interface.interface, tiny_gea_broadcast_address, 1, &payload, send_callback);
+  }
+
+  void given_the_nodes_are_synchronized()
+  {
+    when_a_broadcast_is_sent_by(sync_node);
+    after(20);
+
+    for(uint8_t i = 0; i < node_count; i++) {
+      CHECK_TRUE(tiny_gea2_tdma_synchronized(&nodes[i].tdma));
+    }
+
+    start_count = 0;
+  }
+
+  tiny_time_source_ticks_t sync_time()
+  {
+    return nodes[0].tdma.sync_time;
+  }
+
+  tiny_time_source_ticks_t ticks_into_frame(tiny_time_source_ticks_t time)
+  {
+    return (tiny_time_source_ticks_t)(time - nodes[0].tdma.frame_start) % frame_ticks;
+  }
+
+  void given_that_node_uses_config(uint8_t address, const tiny_gea2_tdma_config_t* node_config)
+  {
+    node_t* n = node(address);
+    tiny_gea2_tdma_init(&n->tdma, &n->gea2_interface, &time_source.interface, node_config, NULL, NULL);
+  }
+
+  void every_start_should_be_in_the_senders_slot()
+  {
+    for(uint8_t i = 0; i < start_count; i++) {
+      tiny_time_source_ticks_t offset = ticks_into_frame(starts[i].time);
+      uint8_t slot = (uint8_t)(offset / slot_ticks);
+
+      CHECK_EQUAL(slot_owners[slot], starts[i].address);
+      CHECK_TRUE((offset % slot_ticks) <= (slot_ticks - guard_ticks));
+    }
+  }
+};
+
+TEST(tiny_gea2_tdma, should_synchronize_every_node_including_the_sync_node_on_the_sync_broadcast)
+{
+  for(uint8_t i = 0; i < node_count; i++) {
+    CHECK_FALSE(tiny_gea2_tdma_synchronized(&nodes[i].tdma));
+  }
+
+  given_the_nodes_are_synchronized();
+
+  CHECK_EQUAL(sync_time(), node(node_a)->tdma.sync_time);
+  CHECK_EQUAL(sync_time(), node(node_b)->tdma.sync_time);
+  CHECK_EQUAL(sync_time(), node(sync_node)->tdma.sync_time);
+}
+
+TEST(tiny_gea2_tdma, should_wait_for_the_start_of_its_own_slot_to_send)
+{
+  given_the_nodes_are_synchronized();
+
+  when_a_broadcast_is_sent_by(node_b);
+  after(frame_ticks);
+
+  CHECK_EQUAL(1, start_count);
+  CHECK_EQUAL(node_b, starts[0].address);
+  CHECK_EQUAL(2 * slot_ticks, ticks_into_frame(starts[0].time));
+}
+
+TEST(tiny_gea2_tdma, should_only_start_sending_in_own_slots_without_collisions_when_every_node_has_packets_queued)
+{
+  given_the_nodes_are_synchronized();
+
+  when_a_broadcast_is_sent_by(node_a);
+  when_a_broadcast_is_sent_by(node_b);
+  when_a_broadcast_is_sent_by(node_a);
+  when_a_broadcast_is_sent_by(node_b);
+  after(3 * frame_ticks);
+
+  CHECK_EQUAL(4, start_count);
+  CHECK_EQUAL(0, collisions);
+  every_start_should_be_in_the_senders_slot();
+
+  CHECK_EQUAL(4, node(sync_node)->packets_received);
+}
+
+TEST(tiny_gea2_tdma, should_give_the_other_nodes_their_slots_when_the_sync_node_has_a_backlog_of_broadcasts)
+{
+  given_the_nodes_are_synchronized();
+
+  when_a_broadcast_is_sent_by(sync_node);
+  when_a_broadcast_is_sent_by(sync_node);
+  when_a_broadcast_is_sent_by(sync_node);
+  when_a_broadcast_is_sent_by(sync_node);
+  when_a_broadcast_is_sent_by(node_a);
+  when_a_broadcast_is_sent_by(node_a);
+  when_a_broadcast_is_sent_by(node_b);
+  when_a_broadcast_is_sent_by(node_b);
+  after(3 * frame_ticks);
+
+  const uint8_t expected_senders[] = { node_a, node_b, sync_node, node_a, node_b, sync_node };
+  CHECK_TRUE(start_count >= element_count(expected_senders));
+  for(uint8_t i = 0; i < element_count(expected_senders); i++) {
+    CHECK_EQUAL(expected_senders[i], starts[i].address);
+  }
+  CHECK_EQUAL(0, collisions);
+}
+
+TEST(tiny_gea2_tdma, should_use_normal_arbitration_when_the_config_has_zero_length_slots)
+{
+  static const tiny_gea2_tdma_config_t zero_length_slots = {
+    .slot_owners = slot_owners,
+    .slot_count = sizeof(slot_owners),
+    .slot_ticks = 0,
+    .guard_ticks = guard_ticks,
+    .sync_address = sync_node,
+    .sync_timeout = sync_timeout
+  };
+
+  given_that_node_uses_config(node_b, &zero_length_slots);
+  when_a_broadcast_is_sent_by(sync_node);
+  after(20);
+  start_count = 0;
+
+  CHECK_TRUE(tiny_gea2_tdma_synchronized(&node(node_a)->tdma));
+  CHECK_FALSE(tiny_gea2_tdma_synchronized(&node(node_b)->tdma));
+
+  when_a_broadcast_is_sent_by(node_b);
+  tiny_time_source_ticks_t sent_at = time_source.ticks;
+  after(10);
+
+  CHECK_EQUAL(1, start_count);
+  CHECK_EQUAL(node_b, starts[0].address);
+  CHECK_TRUE((tiny_time_source_ticks_t)(starts[0].time - sent_at) <= 2);
+}
+
+TEST(tiny_gea2_tdma, should_fall_back_to_normal_arbitration_when_sync_is_lost)
+{
+  given_the_nodes_are_synchronized();
+
+  after(sync_timeout);
+  CHECK_FALSE(tiny_gea2_tdma_synchronized(&node(node_b)->tdma));
+
+  when_a_broadcast_is_sent_by(node_b);
+  tiny_time_source_ticks_t sent_at = time_source.ticks;
+  after(10);
+
+  CHECK_EQUAL(1, start_count);
+  CHECK_EQUAL(node_b, starts[0].address);
+  CHECK_TRUE((tiny_time_source_ticks_t)(starts[0].time - sent_at) <= 2);
+}
+
+TEST(tiny_gea2_tdma, should_resynchronize_on_the_next_sync_broadcast)
+{
+  given_the_nodes_are_synchronized();
+
+  after(sync_timeout);
+  CHECK_FALSE(tiny_gea2_tdma_synchronized(&node(node_a)->tdma));
+
+  given_the_nodes_are_synchronized();
+}
@@ -0,0 +1,196 @@
+/*!
+ * @file
+ * @brief
+ */
+
+extern "C" {
+#include <string.h>
+#include "tiny_gea2_utilization_meter.h"
+#include "tiny_gea_constants.h"
+#include "tiny_utils.h"
+}
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+#include "double/tiny_time_source_double.hpp"
+#include "double/tiny_uart_double.hpp"
+
+enum {
+  address = 0xAD,
+  baud = 19200,
+  ticks_per_second = 1000,
+  window_ticks = 1000
+};
+
+TEST_GROUP(tiny_gea2_utilization_meter)
+{
+  tiny_gea2_utilization_meter_t self;
+
+  tiny_gea2_interface_t gea2_interface;
+  tiny_uart_double_t uart;
+  tiny_time_source_double_t time_source;
+  tiny_event_t msec_interrupt;
+  uint8_t receive_buffer[9];
+  uint8_t send_queue_buffer[20];
+
+  void setup()
+  {
+    mock().disable();
+
+    tiny_event_init(&msec_interrupt);
+    tiny_uart_double_init(&uart);
+    tiny_uart_double_configure_automatic_send_complete(&uart, true);
+    tiny_time_source_double_init(&time_source);
+
+    tiny_gea2_interface_init(
+      &gea2_interface,
+      &uart.interface,
+      &time_source.interface,
+      &msec_interrupt.interface,
+      address,
+      send_queue_buffer,
+      sizeof(send_queue_buffer),
+      receive_buffer,
+      sizeof(receive_buffer),
+      false,
+      0);
+
+    tiny_gea2_utilization_meter_init(
+      &self,
+      &gea2_interface,
+      &uart.interface,
+      &time_source.interface,
+      baud,
+      ticks_per_second,
+      window_ticks);
+  }
+
+  void teardown()
+  {
+    mock().enable();
+  }
+
+  static void send_callback(void*, tiny_gea_packet_t*)
+  {
+  }
+
+  void after_a_packet_is_sent()
+  {
+    tiny_gea_interface_send(&gea2_interface.interface, 0x45, 0, NULL, send_callback);
+    tiny_event_publish(&msec_interrupt, NULL);
+  }
+
+  void after_a_byte_is_received(uint8_t byte)
+  {
+    tiny_uart_double_trigger_receive(&uart, byte);
+  }
+
+  void after(tiny_time_source_ticks_t ticks)
+  {
+    for(tiny_time_source_ticks_t i = 0; i < ticks; i++) {
+      tiny_time_source_double_tick(&time_source, 1);
+      tiny_event_publish(&msec_interrupt, NULL);
+    }
+  }
+
+  void after_a_diagnostics_event_is_raised(tiny_gea2_interface_diagnostics_event_type_t type, uint16_t times)
+  {
+    tiny_gea2_interface_diagnostics_event_args_t args = {};
+    args.type = type;
+
+    for(uint16_t i = 0; i < times; i++) {
+      tiny_event_publish(&gea2_interface.on_diagnostics_event, &args);
+    }
+  }
+
+  void after_the_meter_is_run()
+  {
+    tiny_gea2_utilization_meter_run(&self);
+  }
+
+  const tiny_gea2_utilization_t* utilization()
+  {
+    return tiny_gea2_utilization_meter_utilization(&self);
+  }
+};
+
+TEST(tiny_gea2_utilization_meter, should_report_an_idle_bus_after_a_window_with_no_activity)
+{
+  after(window_ticks);
+  after_the_meter_is_run();
+
+  CHECK_EQUAL(0, utilization()->busy_permille);
+  CHECK_EQUAL(0, utilization()->transmit_share_permille);
+  CHECK_EQUAL(0, utilization()->bytes_per_second);
+  CHECK_EQUAL(0, utilization()->packets_per_second);
+  CHECK_EQUAL(0, utilization()->retries_per_packet_x100);
+  CHECK_EQUAL(0, utilization()->collision_permille);
+}
+
+TEST(tiny_gea2_utilization_meter, should_not_complete_a_window_early)
+{
+  tiny_uart_double_enable_echo(&uart);
+  after_a_packet_is_sent();
+  after_a_byte_is_received(tiny_gea_ack);
+
+  after(window_ticks - 1);
+  after_the_meter_is_run();
+
+  CHECK_EQUAL(0, utilization()->bytes_per_second);
+}
+
+TEST(tiny_gea2_utilization_meter, should_measure_bus_activity_and_this_nodes_share_of_it)
+{
+  tiny_uart_double_enable_echo(&uart);
+  after_a_packet_is_sent();
+  after_a_byte_is_received(tiny_gea_ack);
+
+  after(window_ticks);
+  after_the_meter_is_run();
+
+  // 7 packet bytes reflected plus an ack, 10 bits each at 19200 baud over 1 second
+  CHECK_EQUAL(4, utilization()->busy_permille);
+  CHECK_EQUAL(875, utilization()->transmit_share_permille);
+  CHECK_EQUAL(8, utilization()->bytes_per_second);
+  CHECK_EQUAL(1, utilization()->packets_per_second);
+  CHECK_EQUAL(0, utilization()->retries_per_packet_x100);
+  CHECK_EQUAL(0, utilization()->collision_permille);
+}
+
+TEST(tiny_gea2_utilization_meter, should_measure_collisions)
+{
+  after_a_packet_is_sent();
+  after_a_byte_is_received(tiny_gea_stx - 1);
+
+  after(window_ticks);
+  after_the_meter_is_run();
+
+  CHECK_EQUAL(1000, utilization()->collision_permille);
+}
+
+TEST(tiny_gea2_utilization_meter, should_saturate_retries_per_packet_when_contention_is_high_and_few_packets_get_through)
+{
+  after_a_diagnostics_event_is_raised(tiny_gea2_interface_diagnostics_event_collision, 1000);
+  after_a_diagnostics_event_is_raised(tiny_gea2_interface_diagnostics_event_packet_sent, 1);
+
+  after(window_ticks);
+  after_the_meter_is_run();
+
+  CHECK_EQUAL(UINT16_MAX, utilization()->retries_per_packet_x100);
+  CHECK_EQUAL(999, utilization()->collision_permille);
+}
+
+TEST(tiny_gea2_utilization_meter, should_start_a_new_window_after_completing_one)
+{
+  tiny_uart_double_enable_echo(&uart);
+  after_a_packet_is_sent();
+  after_a_byte_is_received(tiny_gea_ack);
+
+  after(window_ticks);
+  after_the_meter_is_run();
+
+  after(window_ticks);
+  after_the_meter_is_run();
+
+  CHECK_EQUAL(0, utilization()->bytes_per_second);
+}
@@ -0,0 +1,167 @@
+/*!
+ * @file
+ * @brief
+ */
+
+extern "C" {
+#include <string.h>
+#include "tiny_gea3_erd_api.h"
+#include "tiny_gea3_erd_client_router.h"
+#include "tiny_utils.h"
+}
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+#include "double/tiny_gea_interface_double.hpp"
+
+enum {
+  endpoint_address = 0xA5,
+  port_count = 2
+};
+
+#define port(_x) _x
+#define request_id(_x) _x
+#define address(_x) _x
+
+TEST_GROUP(tiny_gea3_erd_client_router)
+{
+  tiny_gea3_erd_client_router_t self;
+  tiny_gea3_erd_client_router_port_t ports[port_count];
+  tiny_gea_interface_double_t gea3_interface;
+  tiny_event_subscription_t port_subscriptions[port_count];
+  uint8_t port_numbers[port_count];
+
+  static void packet_received(void* context, const void* _args)
+  {
+    reinterpret(args, _args, const tiny_gea_interface_on_receive_args_t*);
+
+    mock()
+      .actualCall("packet_received")
+      .withParameter("port", *(const uint8_t*)context)
+      .withParameter("command", args->packet->payload[0])
+      .withParameter("request_id", args->packet->payload[1]);
+  }
+
+  void setup()
+  {
+    tiny_gea_interface_double_init(&gea3_interface, endpoint_address);
+    tiny_gea3_erd_client_router_init(&self, &gea3_interface.interface, ports, port_count);
+
+    for(uint8_t i = 0; i < port_count; i++) {
+      port_numbers[i] = i;
+      tiny_event_subscription_init(&port_subscriptions[i], &port_numbers[i], packet_received);
+      tiny_event_subscribe(tiny_gea_interface_on_receive(tiny_gea3_erd_client_router_port(&self, i)), &port_subscriptions[i]);
+    }
+  }
+
+  static void read_request_worker(void* context, tiny_gea_packet_t* packet)
+  {
+    reinterpret(payload, packet->payload, tiny_gea3_erd_api_read_request_payload_t*);
+    payload->command = tiny_gea3_erd_api_command_read_request;
+    payload->request_id = *(const tiny_gea3_erd_api_request_id_t*)context;
+    payload->erd_msb = 0x12;
+    payload->erd_lsb = 0x34;
+  }
+
+  void after_a_read_request_is_sent_through_port(uint8_t port, tiny_gea3_erd_api_request_id_t request_id, uint8_t address)
+  {
+    mock().disable();
+    tiny_gea_interface_send(
+      tiny_gea3_erd_client_router_port(&self, port),
+      address,
+      sizeof(tiny_gea3_erd_api_read_request_payload_t),
+      &request_id,
+      read_request_worker);
+    mock().enable();
+  }
+
+  void after_a_packet_is_received(uint8_t command, uint8_t request_id)
+  {
+    tiny_gea_STACK_ALLOC_PACKET(packet, 2);
+    packet->source = 0x54;
+    packet->destination = endpoint_address;
+    packet->payload[0] = command;
+    packet->payload[1] = request_id;
+
+    tiny_gea_interface_double_trigger_receive(&gea3_interface, packet);
+  }
+
+  void the_packet_should_be_received_by_port(uint8_t port, uint8_t command, uint8_t request_id)
+  {
+    mock()
+      .expectOneCall("packet_received")
+      .withParameter("port", port)
+      .withParameter("command", command)
+      .withParameter("request_id", request_id);
+  }
+};
+
+TEST(tiny_gea3_erd_client_router, should_send_packets_through_the_shared_interface)
+{
+  static const uint8_t payload[] = { tiny_gea3_erd_api_command_read_request, 0x81, 0x12, 0x34 };
+
+  mock()
+    .expectOneCall("send")
+    .onObject(&gea3_interface)
+    .withParameter("source", endpoint_address)
+    .withParameter("destination", 0x54)
+    .withMemoryBufferParameter("payload", payload, sizeof(payload));
+
+  tiny_gea3_erd_api_request_id_t request_id = 0x81;
+  tiny_gea_interface_send(
+    tiny_gea3_erd_client_router_port(&self, port(1)),
+    address(0x54),
+    sizeof(tiny_gea3_erd_api_read_request_payload_t),
+    &request_id,
+    read_request_worker);
+}
+
+TEST(tiny_gea3_erd_client_router, should_deliver_responses_only_to_the_port_that_sent_the_request)
+{
+  after_a_read_request_is_sent_through_port(port(0), request_id(0x01), address(0x54));
+  after_a_read_request_is_sent_through_port(port(1), request_id(0x81), address(0x54));
+
+  the_packet_should_be_received_by_port(port(0), tiny_gea3_erd_api_command_read_response, request_id(0x01));
+  after_a_packet_is_received(tiny_gea3_erd_api_command_read_response, request_id(0x01));
+
+  the_packet_should_be_received_by_port(port(1), tiny_gea3_erd_api_command_write_response, request_id(0x81));
+  after_a_packet_is_received(tiny_gea3_erd_api_command_write_response, request_id(0x81));
+}
+
+TEST(tiny_gea3_erd_client_router, should_not_give_ownership_of_a_request_id_to_a_port_outside_of_its_range)
+{
+  after_a_read_request_is_sent_through_port(port(0), request_id(0x01), address(0x54));
+  after_a_read_request_is_sent_through_port(port(1), request_id(0x01), address(0x54));
+
+  the_packet_should_be_received_by_port(port(0), tiny_gea3_erd_api_command_read_response, request_id(0x01));
+  after_a_packet_is_received(tiny_gea3_erd_api_command_read_response, request_id(0x01));
+}
+
+TEST(tiny_gea3_erd_client_router, should_split_the_request_ids_evenly_between_the_ports)
+{
+  tiny_gea3_erd_client_configuration_t configuration = {};
+
+  tiny_gea3_erd_client_router_configure_port(&self, port(0), &configuration);
+  CHECK_EQUAL(0x00, configuration.first_request_id);
+  CHECK_EQUAL(0x80, configuration.request_id_count);
+
+  tiny_gea3_erd_client_router_configure_port(&self, port(1), &configuration);
+  CHECK_EQUAL(0x80, configuration.first_request_id);
+  CHECK_EQUAL(0x80, configuration.request_id_count);
+}
+
+TEST(tiny_gea3_erd_client_router, should_deliver_responses_to_unknown_request_ids_to_every_port)
+{
+  the_packet_should_be_received_by_port(port(0), tiny_gea3_erd_api_command_read_response, request_id(0x07));
+  the_packet_should_be_received_by_port(port(1), tiny_gea3_erd_api_command_read_response, request_id(0x07));
+  after_a_packet_is_received(tiny_gea3_erd_api_command_read_response, request_id(0x07));
+}
+
+TEST(tiny_gea3_erd_client_router, should_deliver_packets_that_are_not_responses_to_every_port)
+{
+  after_a_read_request_is_sent_through_port(port(0), request_id(0x01), address(0x54));
+
+  the_packet_should_be_received_by_port(port(0), tiny_gea3_erd_api_command_publication, 0x01);
+  the_packet_should_be_received_by_port(port(1), tiny_gea3_erd_api_command_publication, 0x01);
+  after_a_packet_is_received(tiny_gea3_erd_api_command_publication, 0x01);
+}
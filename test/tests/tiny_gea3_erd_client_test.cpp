@@ -18,7 +18,10 @@ extern "C" {
 enum {
   endpoint_address = 0xA5,
   request_retries = 3,
-  request_timeout = 500
+  request_timeout = 500,
+  priority_burst_limit = 2,
+  address_run_limit = 2,
+  gather_window = 100
 };
 
 #define request_id(_x) _x
@@ -33,11 +36,18 @@ enum {
 
 static const tiny_gea3_erd_client_configuration_t configuration = {
   .request_timeout = request_timeout,
-  .request_retries = request_retries
+  .request_retries = request_retries,
+  .priority_burst_limit = priority_burst_limit,
+  .address_run_limit = 0,
+  .gather_window = gather_window,
+  .first_request_id = 0,
+  .request_id_count = 0
 };
 
 static tiny_gea3_erd_client_request_id_t lastRequestId;
 static size_t expected_data_size;
+static uintptr_t write_completed_stack_depth_min;
+static uintptr_t write_completed_stack_depth_max;
 
 TEST_GROUP(tiny_gea3_erd_client)
 {
@@ -45,9 +55,13 @@ TEST_GROUP(tiny_gea3_erd_client)
 
   tiny_event_subscription_t activity_subscription;
   tiny_event_subscription_t request_again_on_request_complete_or_failed_subscription;
+  tiny_event_subscription_t publication_batch_subscription;
+  tiny_event_subscription_t cancel_on_first_write_completed_subscription;
   tiny_timer_group_double_t timer_group;
+  tiny_gea3_erd_client_configuration_t client_configuration;
   tiny_gea_interface_double_t gea3_interface;
-  uint8_t queue_buffer[25];
+  uint8_t queue_buffer[55];
+  uint8_t large_queue_buffer[512];
 
   static void on_activity(void*, const void* _args)
   {
@@ -171,9 +185,49 @@ TEST_GROUP(tiny_gea3_erd_client)
           .actualCall("SubscriptionHostCameOnline")
           .withParameter("address", args->address);
         break;
+
+      case tiny_gea3_erd_client_activity_type_gather_read_completed:
+        mock()
+          .actualCall("gather_read_completed")
+          .withParameter("request_id", args->gather_read_completed.request_id)
+          .withParameter("erd", args->gather_read_completed.erd)
+          .withParameter("responder_count", args->gather_read_completed.responder_count);
+        break;
+
+      case tiny_gea3_erd_client_activity_type_batch_completed:
+        mock()
+          .actualCall("batch_completed")
+          .withParameter("request_id", args->batch_completed.request_id)
+          .withParameter("item_count", args->batch_completed.item_count)
+          .withParameter("failed_count", args->batch_completed.failed_count);
+        break;
     }
   }
 
+  // Cancels the write that just completed, which is no longer queued, and the last queued write
+  static void cancel_on_first_write_completed(void* context, const void* _args)
+  {
+    reinterpret(self, context, i_tiny_gea3_erd_client_t*);
+    reinterpret(args, _args, const tiny_gea3_erd_client_on_activity_args_t*);
+    uint8_t stack_marker = 0;
+    uintptr_t stack_depth = (uintptr_t)&stack_marker;
+
+    if(args->type != tiny_gea3_erd_client_activity_type_write_completed) {
+      return;
+    }
+
+    if(write_completed_stack_depth_min == 0) {
+      write_completed_stack_depth_min = stack_depth;
+      write_completed_stack_depth_max = stack_depth;
+
+      CHECK_FALSE(tiny_gea3_erd_client_cancel(self, args->write_completed.request_id));
+      CHECK_TRUE(tiny_gea3_erd_client_cancel(self, lastRequestId));
+    }
+
+    write_completed_stack_depth_min = stack_depth < write_completed_stack_depth_min ? stack_depth : write_completed_stack_depth_min;
+    write_completed_stack_depth_max = stack_depth > write_completed_stack_depth_max ? stack_depth : write_completed_stack_depth_max;
+  }
+
   static void request_again_on_request_complete_or_failed(void* context, const void* _args)
   {
     reinterpret(self, context, i_tiny_gea3_erd_client_t*);
@@ -206,12 +260,39 @@ TEST_GROUP(tiny_gea3_erd_client)
     }
   }
 
+  static void on_publication_batch(void*, const void* _args)
+  {
+    reinterpret(args, _args, const tiny_gea3_erd_client_on_activity_args_t*);
+
+    if(args->type == tiny_gea3_erd_client_activity_type_subscription_publication_batch_received) {
+      mock()
+        .actualCall("subscription_publication_batch_received")
+        .withParameter("address", args->address)
+        .withParameter("erd_count", args->subscription_publication_batch_received.erd_count);
+
+      tiny_gea3_erd_client_publication_iterator_t iterator;
+      tiny_gea3_erd_client_publication_iterator_init(&iterator, args);
+
+      tiny_gea3_erd_client_publication_entry_t entry;
+      while(tiny_gea3_erd_client_publication_iterator_next(&iterator, &entry)) {
+        reinterpret(data, entry.data, const uint8_t*);
+
+        mock()
+          .actualCall("publication_batch_entry")
+          .withParameter("erd", entry.erd)
+          .withParameter("data", (entry.data_size == sizeof(uint16_t)) ? ((data[0] << 8) + data[1]) : data[0])
+          .withParameter("data_size", entry.data_size);
+      }
+    }
+  }
+
   void setup()
   {
     tiny_gea_interface_double_init(&gea3_interface, endpoint_address);
     tiny_timer_group_double_init(&timer_group);
 
     memset(&self, 0xA5, sizeof(self));
+    client_configuration = configuration;
 
     tiny_gea3_erd_client_init(
       &self,
@@ -219,12 +300,63 @@ TEST_GROUP(tiny_gea3_erd_client)
       &gea3_interface.interface,
       queue_buffer,
       sizeof(queue_buffer),
-      &configuration);
+      &client_configuration);
 
     tiny_event_subscription_init(&activity_subscription, nullptr, on_activity);
     tiny_event_subscribe(tiny_gea3_erd_client_on_activity(&self.interface), &activity_subscription);
 
     tiny_event_subscription_init(&request_again_on_request_complete_or_failed_subscription, &self, request_again_on_request_complete_or_failed);
+    tiny_event_subscription_init(&publication_batch_subscription, nullptr, on_publication_batch);
+    tiny_event_subscription_init(&cancel_on_first_write_completed_subscription, &self, cancel_on_first_write_completed);
+
+    write_completed_stack_depth_min = 0;
+    write_completed_stack_depth_max = 0;
+  }
+
+  void given_that_publication_batches_are_being_observed()
+  {
+    tiny_event_subscribe(tiny_gea3_erd_client_on_activity(&self.interface), &publication_batch_subscription);
+  }
+
+  void given_that_requests_are_grouped_by_address()
+  {
+    client_configuration.address_run_limit = address_run_limit;
+  }
+
+  void given_that_the_client_uses_request_ids(tiny_gea3_erd_api_request_id_t first_request_id, uint8_t request_id_count)
+  {
+    client_configuration.first_request_id = first_request_id;
+    client_configuration.request_id_count = request_id_count;
+
+    tiny_gea_interface_double_init(&gea3_interface, endpoint_address);
+
+    tiny_gea3_erd_client_init(
+      &self,
+      &timer_group.timer_group,
+      &gea3_interface.interface,
+      queue_buffer,
+      sizeof(queue_buffer),
+      &client_configuration);
+
+    tiny_event_subscribe(tiny_gea3_erd_client_on_activity(&self.interface), &activity_subscription);
+  }
+
+  void given_that_the_client_has_a_large_request_queue()
+  {
+    tiny_gea3_erd_client_init(
+      &self,
+      &timer_group.timer_group,
+      &gea3_interface.interface,
+      large_queue_buffer,
+      sizeof(large_queue_buffer),
+      &client_configuration);
+
+    tiny_event_subscribe(tiny_gea3_erd_client_on_activity(&self.interface), &activity_subscription);
+  }
+
+  void given_that_the_client_will_cancel_on_the_first_write_completed()
+  {
+    tiny_event_subscribe(tiny_gea3_erd_client_on_activity(&self.interface), &cancel_on_first_write_completed_subscription);
   }
 
   void given_that_the_client_will_request_again_on_complete_or_failed()
@@ -449,6 +581,23 @@ TEST_GROUP(tiny_gea3_erd_client)
     tiny_gea_interface_double_trigger_receive(&gea3_interface, packet);
   }
 
+  void after_a_publication_that_claims_more_erds_than_it_contains_is_received(tiny_gea3_erd_api_request_id_t request_id, uint8_t address, uint8_t context, tiny_erd_t erd, uint8_t data)
+  {
+    tiny_gea_STACK_ALLOC_PACKET(packet, 8);
+    packet->source = address;
+    packet->destination = endpoint_address;
+    packet->payload[0] = tiny_gea3_erd_api_command_publication;
+    packet->payload[1] = context;
+    packet->payload[2] = request_id;
+    packet->payload[3] = 2;
+    packet->payload[4] = erd >> 8;
+    packet->payload[5] = erd & 0xFF;
+    packet->payload[6] = sizeof(data);
+    packet->payload[7] = data;
+
+    tiny_gea_interface_double_trigger_receive(&gea3_interface, packet);
+  }
+
   void after_a_subscription_host_startup_is_received(uint8_t address)
   {
     tiny_gea_STACK_ALLOC_PACKET(packet, 1);
@@ -493,6 +642,70 @@ TEST_GROUP(tiny_gea3_erd_client)
     CHECK(success);
   }
 
+  void after_a_read_is_requested_with_a_deadline(uint8_t address, tiny_erd_t erd, tiny_time_source_ticks_t deadline)
+  {
+    tiny_gea3_erd_client_request_options_t options = { deadline, 0, false };
+    bool success = tiny_gea3_erd_client_read_with_options(&self.interface, &lastRequestId, address, erd, &options);
+    CHECK(success);
+  }
+
+  void after_a_write_is_requested_with_a_deadline(uint8_t address, tiny_erd_t erd, uint8_t data, tiny_time_source_ticks_t deadline)
+  {
+    tiny_gea3_erd_client_request_options_t options = { deadline, 0, false };
+    bool success = tiny_gea3_erd_client_write_with_options(&self.interface, &lastRequestId, address, erd, &data, sizeof(data), &options);
+    CHECK(success);
+  }
+
+  void after_a_read_is_requested_with_priority(uint8_t address, tiny_erd_t erd, uint8_t priority)
+  {
+    tiny_gea3_erd_client_request_options_t options = { 0, priority, false };
+    bool success = tiny_gea3_erd_client_read_with_options(&self.interface, &lastRequestId, address, erd, &options);
+    CHECK(success);
+  }
+
+  void after_a_write_is_requested_with_priority(uint8_t address, tiny_erd_t erd, uint8_t data, uint8_t priority)
+  {
+    tiny_gea3_erd_client_request_options_t options = { 0, priority, false };
+    bool success = tiny_gea3_erd_client_write_with_options(&self.interface, &lastRequestId, address, erd, &data, sizeof(data), &options);
+    CHECK(success);
+  }
+
+  void after_an_unacknowledged_write_is_requested(uint8_t address, tiny_erd_t erd, uint8_t data)
+  {
+    tiny_gea3_erd_client_request_options_t options = { 0, 0, true };
+    bool success = tiny_gea3_erd_client_write_with_options(&self.interface, &lastRequestId, address, erd, &data, sizeof(data), &options);
+    CHECK(success);
+  }
+
+  void after_the_request_is_cancelled(tiny_gea3_erd_client_request_id_t request_id)
+  {
+    bool success = tiny_gea3_erd_client_cancel(&self.interface, request_id);
+    CHECK(success);
+  }
+
+  void should_fail_to_cancel_the_request(tiny_gea3_erd_client_request_id_t request_id)
+  {
+    CHECK_FALSE(tiny_gea3_erd_client_cancel(&self.interface, request_id));
+  }
+
+  void after_a_gather_read_is_requested(tiny_erd_t erd)
+  {
+    bool success = tiny_gea3_erd_client_gather_read(&self.interface, &lastRequestId, erd);
+    CHECK(success);
+  }
+
+  void after_a_read_batch_is_requested(tiny_gea3_erd_client_batch_item_t* items, uint8_t item_count)
+  {
+    bool success = tiny_gea3_erd_client_read_batch(&self.interface, &lastRequestId, items, item_count);
+    CHECK(success);
+  }
+
+  void after_a_write_batch_is_requested(tiny_gea3_erd_client_batch_item_t* items, uint8_t item_count)
+  {
+    bool success = tiny_gea3_erd_client_write_batch(&self.interface, &lastRequestId, items, item_count);
+    CHECK(success);
+  }
+
   void after_subscribe_is_requested(uint8_t address)
   {
     bool success = tiny_gea3_erd_client_subscribe(&self.interface, address);
@@ -699,6 +912,50 @@ TEST_GROUP(tiny_gea3_erd_client)
       .ignoreOtherParameters();
   }
 
+  void should_publish_a_subscription_publication_batch(uint8_t address, uint8_t erd_count)
+  {
+    mock()
+      .expectOneCall("subscription_publication_batch_received")
+      .withParameter("address", address)
+      .withParameter("erd_count", erd_count);
+  }
+
+  void with_a_batch_entry(tiny_erd_t erd, uint8_t data)
+  {
+    mock()
+      .expectOneCall("publication_batch_entry")
+      .withParameter("erd", erd)
+      .withParameter("data", data)
+      .withParameter("data_size", sizeof(data));
+  }
+
+  void with_a_batch_entry(tiny_erd_t erd, uint16_t data)
+  {
+    mock()
+      .expectOneCall("publication_batch_entry")
+      .withParameter("erd", erd)
+      .withParameter("data", data)
+      .withParameter("data_size", sizeof(data));
+  }
+
+  void should_publish_gather_read_completed(tiny_erd_t erd, uint16_t responder_count, tiny_gea3_erd_client_request_id_t request_id)
+  {
+    mock()
+      .expectOneCall("gather_read_completed")
+      .withParameter("request_id", request_id)
+      .withParameter("erd", erd)
+      .withParameter("responder_count", responder_count);
+  }
+
+  void should_publish_batch_completed(uint8_t item_count, uint8_t failed_count, tiny_gea3_erd_client_request_id_t request_id)
+  {
+    mock()
+      .expectOneCall("batch_completed")
+      .withParameter("request_id", request_id)
+      .withParameter("item_count", item_count)
+      .withParameter("failed_count", failed_count);
+  }
+
   void should_publish_subscription_host_came_online(uint8_t address)
   {
     mock()
@@ -875,6 +1132,38 @@ TEST(tiny_gea3_erd_client, should_acknowledge_publications_with_multiple_erds)
   after_a_subscription_publication_is_received(request_id(123), address(0x42), context(0xA5), erd(0x8888), (uint8_t)5, erd(0x1616), (uint16_t)4242);
 }
 
+TEST(tiny_gea3_erd_client, should_publish_all_erds_in_a_publication_as_a_single_batch)
+{
+  given_that_publication_batches_are_being_observed();
+
+  should_publish_subscription_publication_received(address(0x42), erd(0x8888), (uint8_t)5);
+  should_publish_subscription_publication_received(address(0x42), erd(0x1616), (uint16_t)4242);
+  should_publish_a_subscription_publication_batch(address(0x42), 2);
+  with_a_batch_entry(erd(0x8888), (uint8_t)5);
+  with_a_batch_entry(erd(0x1616), (uint16_t)4242);
+  a_subscription_publication_acknowledgment_should_be_sent(request_id(123), address(0x42), context(0xA5));
+  after_a_subscription_publication_is_received(request_id(123), address(0x42), context(0xA5), erd(0x8888), (uint8_t)5, erd(0x1616), (uint16_t)4242);
+}
+
+TEST(tiny_gea3_erd_client, should_publish_a_batch_for_single_erd_publications)
+{
+  given_that_publication_batches_are_being_observed();
+
+  should_publish_subscription_publication_received(address(0x42), erd(0x1234), (uint8_t)5);
+  should_publish_a_subscription_publication_batch(address(0x42), 1);
+  with_a_batch_entry(erd(0x1234), (uint8_t)5);
+  a_subscription_publication_acknowledgment_should_be_sent(request_id(123), address(0x42), context(0xA5));
+  after_a_subscription_publication_is_received(request_id(123), address(0x42), context(0xA5), erd(0x1234), (uint8_t)5);
+}
+
+TEST(tiny_gea3_erd_client, should_not_publish_or_acknowledge_any_record_of_a_malformed_publication)
+{
+  given_that_publication_batches_are_being_observed();
+
+  nothing_should_happen();
+  after_a_publication_that_claims_more_erds_than_it_contains_is_received(request_id(123), address(0x42), context(0xA5), erd(0x1234), (uint8_t)5);
+}
+
 TEST(tiny_gea3_erd_client, should_indicate_when_a_subscription_host_has_come_online)
 {
   should_publish_subscription_host_came_online(address(0x42));
@@ -1279,6 +1568,25 @@ TEST(tiny_gea3_erd_client, should_provide_the_same_request_id_for_duplicate_read
   with_an_expected_request_id(1);
 }
 
+TEST(tiny_gea3_erd_client, should_keep_request_ids_unique_after_the_request_id_sent_on_the_wire_rolls_over)
+{
+  for(uint16_t i = 0; i < 256; i++) {
+    a_read_request_should_be_sent(request_id((uint8_t)i), address(0x54), erd(0x1234));
+    after_a_read_is_requested(address(0x54), erd(0x1234));
+    with_an_expected_request_id(i);
+
+    should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(i));
+    after_a_read_response_is_received(request_id((uint8_t)i), address(0x54), erd(0x1234), (uint8_t)123);
+  }
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  with_an_expected_request_id(256);
+
+  and_then should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(256));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+}
+
 TEST(tiny_gea3_erd_client, should_provide_request_ids_for_write_requests)
 {
   a_write_request_should_be_sent(request_id(0), address(0x56), erd(0xABCD), (uint8_t)42);
@@ -1325,3 +1633,526 @@ TEST(tiny_gea3_erd_client, should_provide_the_same_request_id_for_duplicate_writ
   after_a_write_is_requested(address(0x56), erd(0x1234), (uint8_t)7);
   with_an_expected_request_id(2);
 }
+
+TEST(tiny_gea3_erd_client, should_fail_a_queued_request_whose_deadline_expires_before_it_is_sent)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_a_deadline(address(0x56), erd(0x5678), 100);
+  after_a_write_is_requested_with_a_deadline(address(0x56), erd(0xABCD), (uint8_t)42, 100);
+
+  nothing_should_happen();
+  after(100);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then should_publish_read_failed(address(0x56), erd(0x5678), request_id(1), tiny_gea3_erd_client_read_failure_reason_deadline_expired);
+  and_then should_publish_write_failed(address(0x56), erd(0xABCD), (uint8_t)42, request_id(2), tiny_gea3_erd_client_write_failure_reason_deadline_expired);
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+}
+
+TEST(tiny_gea3_erd_client, should_send_a_queued_request_whose_deadline_has_not_expired)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_a_deadline(address(0x56), erd(0x5678), 100);
+
+  nothing_should_happen();
+  after(99);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then a_read_request_should_be_sent(request_id(1), address(0x56), erd(0x5678));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+}
+
+TEST(tiny_gea3_erd_client, should_not_merge_a_request_into_a_queued_duplicate_with_different_options)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_a_deadline(address(0x56), erd(0x5678), 100);
+  after_a_read_is_requested(address(0x56), erd(0x5678));
+  with_an_expected_request_id(2);
+
+  nothing_should_happen();
+  after(100);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then should_publish_read_failed(address(0x56), erd(0x5678), request_id(1), tiny_gea3_erd_client_read_failure_reason_deadline_expired);
+  and_then a_read_request_should_be_sent(request_id(2), address(0x56), erd(0x5678));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+}
+
+TEST(tiny_gea3_erd_client, should_fail_an_in_flight_request_instead_of_retrying_once_its_deadline_expires)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_a_deadline(address(0x54), erd(0x1234), request_timeout + 1);
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after(request_timeout);
+
+  should_publish_read_failed(address(0x54), erd(0x1234), request_id(0), tiny_gea3_erd_client_read_failure_reason_deadline_expired);
+  after(request_timeout);
+
+  nothing_should_happen();
+  after(request_timeout * 5);
+}
+
+TEST(tiny_gea3_erd_client, should_not_send_a_cancelled_request)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_write_is_requested(address(0x56), erd(0x5678), (uint8_t)21);
+  after_the_request_is_cancelled(request_id(1));
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  nothing_should_happen();
+  after(request_timeout * 5);
+}
+
+TEST(tiny_gea3_erd_client, should_ignore_responses_to_a_cancelled_in_flight_request)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+
+  a_read_request_should_be_sent(request_id(1), address(0x54), erd(0x5678));
+  after_a_read_is_requested(address(0x54), erd(0x5678));
+  after_the_request_is_cancelled(request_id(0));
+
+  nothing_should_happen();
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_publish_read_completed(address(0x54), erd(0x5678), (uint8_t)21, request_id(1));
+  after_a_read_response_is_received(request_id(1), address(0x54), erd(0x5678), (uint8_t)21);
+}
+
+TEST(tiny_gea3_erd_client, should_indicate_when_a_request_to_cancel_cannot_be_found)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+
+  should_fail_to_cancel_the_request(request_id(1));
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_fail_to_cancel_the_request(request_id(0));
+}
+
+TEST(tiny_gea3_erd_client, should_send_higher_priority_requests_first)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x5678), 0);
+  after_a_write_is_requested_with_priority(address(0x56), erd(0xABCD), (uint8_t)42, 1);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then a_write_request_should_be_sent(request_id(1), address(0x56), erd(0xABCD), (uint8_t)42);
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_publish_write_completed(address(0x56), erd(0xABCD), (uint8_t)42, request_id(2));
+  and_then a_read_request_should_be_sent(request_id(2), address(0x54), erd(0x5678));
+  after_a_write_response_is_received(request_id(1), address(0x56), erd(0xABCD), tiny_gea3_erd_api_write_result_success);
+}
+
+TEST(tiny_gea3_erd_client, should_not_send_a_higher_priority_request_ahead_of_an_older_write_to_the_same_erd)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_a_write_is_requested_with_priority(address(0x56), erd(0xABCD), (uint8_t)42, 0);
+  after_a_read_is_requested_with_priority(address(0x56), erd(0xABCD), 1);
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  and_then a_write_request_should_be_sent(request_id(1), address(0x56), erd(0xABCD), (uint8_t)42);
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_publish_write_completed(address(0x56), erd(0xABCD), (uint8_t)42, request_id(1));
+  and_then a_read_request_should_be_sent(request_id(2), address(0x56), erd(0xABCD));
+  after_a_write_response_is_received(request_id(1), address(0x56), erd(0xABCD), tiny_gea3_erd_api_write_result_success);
+}
+
+TEST(tiny_gea3_erd_client, should_only_consider_the_oldest_requests_for_sending_early)
+{
+  given_that_the_client_has_a_large_request_queue();
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x0000));
+  after_a_read_is_requested(address(0x54), erd(0x0000));
+
+  for(uint16_t i = 1; i <= 8; i++) {
+    after_a_read_is_requested_with_priority(address(0x54), erd(i), 0);
+  }
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x00FF), 1);
+
+  should_publish_read_completed(address(0x54), erd(0x0000), (uint8_t)123, request_id(0));
+  and_then a_read_request_should_be_sent(request_id(1), address(0x54), erd(0x0001));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x0000), (uint8_t)123);
+
+  should_publish_read_completed(address(0x54), erd(0x0001), (uint8_t)123, request_id(1));
+  and_then a_read_request_should_be_sent(request_id(2), address(0x54), erd(0x00FF));
+  after_a_read_response_is_received(request_id(1), address(0x54), erd(0x0001), (uint8_t)123);
+}
+
+TEST(tiny_gea3_erd_client, should_send_the_oldest_request_after_a_burst_of_higher_priority_requests)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x54), erd(0x0001));
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x0002), 0);
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x0003), 1);
+
+  should_publish_read_completed(address(0x54), erd(0x0001), (uint8_t)123, request_id(0));
+  and_then a_read_request_should_be_sent(request_id(1), address(0x54), erd(0x0003));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x0001), (uint8_t)123);
+
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x0004), 1);
+
+  should_publish_read_completed(address(0x54), erd(0x0003), (uint8_t)123, request_id(2));
+  and_then a_read_request_should_be_sent(request_id(2), address(0x54), erd(0x0004));
+  after_a_read_response_is_received(request_id(1), address(0x54), erd(0x0003), (uint8_t)123);
+
+  after_a_read_is_requested_with_priority(address(0x54), erd(0x0005), 1);
+
+  should_publish_read_completed(address(0x54), erd(0x0004), (uint8_t)123, request_id(3));
+  and_then a_read_request_should_be_sent(request_id(3), address(0x54), erd(0x0002));
+  after_a_read_response_is_received(request_id(2), address(0x54), erd(0x0004), (uint8_t)123);
+
+  should_publish_read_completed(address(0x54), erd(0x0002), (uint8_t)123, request_id(1));
+  and_then a_read_request_should_be_sent(request_id(4), address(0x54), erd(0x0005));
+  after_a_read_response_is_received(request_id(3), address(0x54), erd(0x0002), (uint8_t)123);
+}
+
+TEST(tiny_gea3_erd_client, should_group_requests_to_the_same_address_when_enabled)
+{
+  given_that_requests_are_grouped_by_address();
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x56), erd(0x0002));
+  after_a_read_is_requested(address(0x54), erd(0x0003));
+
+  should_publish_read_completed(address(0x54), erd(0x0001), (uint8_t)123, request_id(0));
+  and_then a_read_request_should_be_sent(request_id(1), address(0x54), erd(0x0003));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x0001), (uint8_t)123);
+
+  should_publish_read_completed(address(0x54), erd(0x0003), (uint8_t)123, request_id(2));
+  and_then a_read_request_should_be_sent(request_id(2), address(0x56), erd(0x0002));
+  after_a_read_response_is_received(request_id(1), address(0x54), erd(0x0003), (uint8_t)123);
+}
+
+TEST(tiny_gea3_erd_client, should_not_send_more_than_the_run_limit_to_one_address_while_other_addresses_wait)
+{
+  given_that_requests_are_grouped_by_address();
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x56), erd(0x0002));
+  after_a_read_is_requested(address(0x54), erd(0x0003));
+
+  should_publish_read_completed(address(0x54), erd(0x0001), (uint8_t)123, request_id(0));
+  and_then a_read_request_should_be_sent(request_id(1), address(0x54), erd(0x0003));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x0001), (uint8_t)123);
+
+  after_a_read_is_requested(address(0x54), erd(0x0004));
+
+  should_publish_read_completed(address(0x54), erd(0x0003), (uint8_t)123, request_id(2));
+  and_then a_read_request_should_be_sent(request_id(2), address(0x56), erd(0x0002));
+  after_a_read_response_is_received(request_id(1), address(0x54), erd(0x0003), (uint8_t)123);
+
+  should_publish_read_completed(address(0x56), erd(0x0002), (uint8_t)123, request_id(1));
+  and_then a_read_request_should_be_sent(request_id(3), address(0x54), erd(0x0004));
+  after_a_read_response_is_received(request_id(2), address(0x56), erd(0x0002), (uint8_t)123);
+}
+
+TEST(tiny_gea3_erd_client, should_not_group_a_request_ahead_of_an_older_broadcast_write_to_the_same_erd)
+{
+  given_that_requests_are_grouped_by_address();
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x0001));
+  after_a_read_is_requested(address(0x54), erd(0x0001));
+  after_a_write_is_requested(address(0xFF), erd(0x0002), (uint8_t)42);
+  after_a_read_is_requested(address(0x54), erd(0x0002));
+
+  should_publish_read_completed(address(0x54), erd(0x0001), (uint8_t)123, request_id(0));
+  and_then a_write_request_should_be_sent(request_id(1), address(0xFF), erd(0x0002), (uint8_t)42);
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x0001), (uint8_t)123);
+
+  should_publish_write_completed(address(0x54), erd(0x0002), (uint8_t)42, request_id(1));
+  and_then a_read_request_should_be_sent(request_id(2), address(0x54), erd(0x0002));
+  after_a_write_response_is_received(request_id(1), address(0x54), erd(0x0002), tiny_gea3_erd_api_write_result_success);
+}
+
+TEST(tiny_gea3_erd_client, should_report_each_responder_to_a_gather_read_and_complete_when_the_window_closes)
+{
+  a_read_request_should_be_sent(request_id(0), address(0xFF), erd(0x1234));
+  after_a_gather_read_is_requested(erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x5678));
+
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_publish_read_completed(address(0x56), erd(0x1234), (uint8_t)21, request_id(0));
+  after_a_read_response_is_received(request_id(0), address(0x56), erd(0x1234), (uint8_t)21);
+
+  nothing_should_happen();
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+  after_a_read_response_is_received(request_id(0), address(0x57), erd(0x5678), (uint8_t)123);
+  after_a_read_response_is_received(request_id(1), address(0x57), erd(0x1234), (uint8_t)123);
+  after_a_read_failure_response_is_received(request_id(0), address(0x58), erd(0x1234), tiny_gea3_erd_api_read_result_unsupported_erd);
+  after(gather_window - 1);
+
+  should_publish_gather_read_completed(erd(0x1234), 2, request_id(0));
+  and_then a_read_request_should_be_sent(request_id(1), address(0x54), erd(0x5678));
+  after(1);
+}
+
+TEST(tiny_gea3_erd_client, should_count_a_response_from_every_address_to_a_gather_read)
+{
+  a_read_request_should_be_sent(request_id(0), address(0xFF), erd(0x1234));
+  after_a_gather_read_is_requested(erd(0x1234));
+
+  for(uint16_t source = 0; source <= 0xFF; source++) {
+    should_publish_read_completed((uint8_t)source, erd(0x1234), (uint8_t)123, request_id(0));
+    after_a_read_response_is_received(request_id(0), (uint8_t)source, erd(0x1234), (uint8_t)123);
+  }
+
+  should_publish_gather_read_completed(erd(0x1234), 256, request_id(0));
+  after(gather_window);
+}
+
+TEST(tiny_gea3_erd_client, should_complete_a_gather_read_without_retrying_when_nothing_responds)
+{
+  a_read_request_should_be_sent(request_id(0), address(0xFF), erd(0x1234));
+  after_a_gather_read_is_requested(erd(0x1234));
+
+  should_publish_gather_read_completed(erd(0x1234), 0, request_id(0));
+  after(gather_window);
+
+  nothing_should_happen();
+  after(request_timeout * 5);
+}
+
+TEST(tiny_gea3_erd_client, should_complete_an_unacknowledged_write_as_soon_as_it_is_sent)
+{
+  a_write_request_should_be_sent(request_id(0), address(0x54), erd(0x1234), (uint8_t)42);
+  should_publish_write_completed(address(0x54), erd(0x1234), (uint8_t)42, request_id(0));
+  after_an_unacknowledged_write_is_requested(address(0x54), erd(0x1234), (uint8_t)42);
+
+  nothing_should_happen();
+  after_a_write_response_is_received(request_id(0), address(0x54), erd(0x1234), tiny_gea3_erd_api_write_result_success);
+  after(request_timeout * 5);
+}
+
+TEST(tiny_gea3_erd_client, should_send_queued_unacknowledged_writes_in_order_without_waiting_for_responses)
+{
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  after_an_unacknowledged_write_is_requested(address(0xFF), erd(0x5678), (uint8_t)1);
+  after_an_unacknowledged_write_is_requested(address(0xFF), erd(0x5678), (uint8_t)2);
+
+  mock().strictOrder();
+  a_write_request_should_be_sent(request_id(1), address(0xFF), erd(0x5678), (uint8_t)1);
+  should_publish_write_completed(address(0xFF), erd(0x5678), (uint8_t)1, request_id(1));
+  a_write_request_should_be_sent(request_id(2), address(0xFF), erd(0x5678), (uint8_t)2);
+  should_publish_write_completed(address(0xFF), erd(0x5678), (uint8_t)2, request_id(2));
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+}
+
+TEST(tiny_gea3_erd_client, should_complete_many_queued_unacknowledged_writes_without_nesting_when_a_handler_cancels)
+{
+  enum { write_count = 20 };
+
+  given_that_the_client_has_a_large_request_queue();
+  given_that_the_client_will_cancel_on_the_first_write_completed();
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+
+  for(uint8_t i = 1; i <= write_count; i++) {
+    after_an_unacknowledged_write_is_requested(address(0xFF), erd(0x5678), i);
+  }
+
+  mock().strictOrder();
+  for(uint8_t i = 1; i < write_count; i++) {
+    a_write_request_should_be_sent(request_id(i), address(0xFF), erd(0x5678), i);
+    should_publish_write_completed(address(0xFF), erd(0x5678), i, request_id(i));
+  }
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)123, request_id(0));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  CHECK_EQUAL(write_completed_stack_depth_min, write_completed_stack_depth_max);
+
+  nothing_should_happen();
+  after(request_timeout * 5);
+}
+
+TEST(tiny_gea3_erd_client, should_read_each_item_in_a_batch_and_complete_once)
+{
+  uint8_t first = 0;
+  uint8_t second[2] = {};
+  tiny_gea3_erd_client_batch_item_t items[] = {
+    { &first, erd(0x1234), address(0x54), sizeof(first), 0 },
+    { second, erd(0x5678), address(0x56), sizeof(second), 0 },
+  };
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_batch_is_requested(items, 2);
+
+  a_read_request_should_be_sent(request_id(1), address(0x56), erd(0x5678));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  should_publish_batch_completed(2, 0, request_id(0));
+  after_a_read_response_is_received(request_id(1), address(0x56), erd(0x5678), (uint16_t)0xABCD);
+
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_completed, items[0].status);
+  CHECK_EQUAL(1, items[0].data_size);
+  CHECK_EQUAL(123, first);
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_completed, items[1].status);
+  CHECK_EQUAL(2, items[1].data_size);
+  CHECK_EQUAL(0xAB, second[0]);
+  CHECK_EQUAL(0xCD, second[1]);
+}
+
+TEST(tiny_gea3_erd_client, should_report_the_status_of_each_item_in_a_read_batch)
+{
+  uint8_t data[3] = {};
+  tiny_gea3_erd_client_batch_item_t items[] = {
+    { &data[0], erd(0x1234), address(0x54), 1, 0 },
+    { &data[1], erd(0x5678), address(0x54), 1, 0 },
+    { &data[2], erd(0x9ABC), address(0x54), 1, 0 },
+  };
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_batch_is_requested(items, 3);
+
+  a_read_request_should_be_sent(request_id(1), address(0x54), erd(0x5678));
+  after_a_read_failure_response_is_received(request_id(0), address(0x54), erd(0x1234), tiny_gea3_erd_api_read_result_unsupported_erd);
+
+  a_read_request_should_be_sent(request_id(2), address(0x54), erd(0x9ABC));
+  after_a_read_response_is_received(request_id(1), address(0x54), erd(0x5678), (uint16_t)1234);
+
+  for(uint8_t retry = 0; retry < request_retries; retry++) {
+    a_read_request_should_be_sent(request_id(2), address(0x54), erd(0x9ABC));
+    after(request_timeout);
+  }
+
+  should_publish_batch_completed(3, 3, request_id(0));
+  after(request_timeout);
+
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_not_supported, items[0].status);
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_incorrect_size, items[1].status);
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_retries_exhausted, items[2].status);
+}
+
+TEST(tiny_gea3_erd_client, should_write_each_item_in_a_batch_and_complete_once)
+{
+  uint8_t first = 42;
+  uint8_t second = 21;
+  tiny_gea3_erd_client_batch_item_t items[] = {
+    { &first, erd(0x1234), address(0x54), sizeof(first), 0 },
+    { &second, erd(0x5678), address(0x56), sizeof(second), 0 },
+  };
+
+  a_write_request_should_be_sent(request_id(0), address(0x54), erd(0x1234), (uint8_t)42);
+  after_a_write_batch_is_requested(items, 2);
+
+  a_write_request_should_be_sent(request_id(1), address(0x56), erd(0x5678), (uint8_t)21);
+  after_a_write_response_is_received(request_id(0), address(0x54), erd(0x1234), tiny_gea3_erd_api_write_result_success);
+
+  should_publish_batch_completed(2, 1, request_id(0));
+  after_a_write_response_is_received(request_id(1), address(0x56), erd(0x5678), tiny_gea3_erd_api_write_result_incorrect_size);
+
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_completed, items[0].status);
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_incorrect_size, items[1].status);
+}
+
+TEST(tiny_gea3_erd_client, should_keep_a_read_queued_behind_a_write_batch_until_the_batch_completes)
+{
+  uint8_t data = 42;
+  tiny_gea3_erd_client_batch_item_t items[] = {
+    { &data, erd(0x1234), address(0x54), sizeof(data), 0 },
+  };
+
+  a_read_request_should_be_sent(request_id(0), address(0x56), erd(0x5678));
+  after_a_read_is_requested(address(0x56), erd(0x5678));
+  after_a_write_batch_is_requested(items, 1);
+
+  tiny_gea3_erd_client_request_options_t options = { 0, 1, false };
+  tiny_gea3_erd_client_read_with_options(&self.interface, &lastRequestId, address(0x54), erd(0x1234), &options);
+
+  should_publish_read_completed(address(0x56), erd(0x5678), (uint8_t)1, request_id(0));
+  a_write_request_should_be_sent(request_id(1), address(0x54), erd(0x1234), (uint8_t)42);
+  after_a_read_response_is_received(request_id(0), address(0x56), erd(0x5678), (uint8_t)1);
+
+  should_publish_batch_completed(1, 0, request_id(1));
+  a_read_request_should_be_sent(request_id(2), address(0x54), erd(0x1234));
+  after_a_write_response_is_received(request_id(1), address(0x54), erd(0x1234), tiny_gea3_erd_api_write_result_success);
+}
+
+TEST(tiny_gea3_erd_client, should_reject_a_batch_whose_items_are_already_in_flight_without_resetting_them)
+{
+  uint8_t first = 0;
+  uint8_t second = 0;
+  tiny_gea3_erd_client_batch_item_t items[] = {
+    { &first, erd(0x1234), address(0x54), sizeof(first), 0 },
+    { &second, erd(0x5678), address(0x54), sizeof(second), 0 },
+  };
+
+  a_read_request_should_be_sent(request_id(0), address(0x54), erd(0x1234));
+  after_a_read_batch_is_requested(items, 2);
+
+  a_read_request_should_be_sent(request_id(1), address(0x54), erd(0x5678));
+  after_a_read_response_is_received(request_id(0), address(0x54), erd(0x1234), (uint8_t)123);
+
+  CHECK_FALSE(tiny_gea3_erd_client_read_batch(&self.interface, &lastRequestId, items, 2));
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_completed, items[0].status);
+
+  should_publish_batch_completed(2, 0, request_id(0));
+  after_a_read_response_is_received(request_id(1), address(0x54), erd(0x5678), (uint8_t)45);
+
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_completed, items[0].status);
+  CHECK_EQUAL(tiny_gea3_erd_client_batch_item_status_completed, items[1].status);
+}
+
+TEST(tiny_gea3_erd_client, should_not_queue_an_empty_batch)
+{
+  tiny_gea3_erd_client_batch_item_t items[1];
+  CHECK_FALSE(tiny_gea3_erd_client_read_batch(&self.interface, &lastRequestId, items, 0));
+  CHECK_FALSE(tiny_gea3_erd_client_write_batch(&self.interface, &lastRequestId, items, 0));
+}
+
+TEST(tiny_gea3_erd_client, should_only_use_request_ids_in_the_configured_range)
+{
+  given_that_the_client_uses_request_ids(0x80, 2);
+
+  a_read_request_should_be_sent(request_id(0x80), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)1, request_id(0));
+  after_a_read_response_is_received(request_id(0x80), address(0x54), erd(0x1234), (uint8_t)1);
+
+  a_read_request_should_be_sent(request_id(0x81), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)2, request_id(1));
+  after_a_read_response_is_received(request_id(0x81), address(0x54), erd(0x1234), (uint8_t)2);
+
+  a_read_request_should_be_sent(request_id(0x80), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+}
+
+TEST(tiny_gea3_erd_client, should_wrap_request_ids_within_a_range_that_crosses_0xFF)
+{
+  given_that_the_client_uses_request_ids(0xFF, 2);
+
+  a_read_request_should_be_sent(request_id(0xFF), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)1, request_id(0));
+  after_a_read_response_is_received(request_id(0xFF), address(0x54), erd(0x1234), (uint8_t)1);
+
+  a_read_request_should_be_sent(request_id(0x00), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+  should_publish_read_completed(address(0x54), erd(0x1234), (uint8_t)2, request_id(1));
+  after_a_read_response_is_received(request_id(0x00), address(0x54), erd(0x1234), (uint8_t)2);
+
+  a_read_request_should_be_sent(request_id(0xFF), address(0x54), erd(0x1234));
+  after_a_read_is_requested(address(0x54), erd(0x1234));
+}
@@ -22,7 +22,10 @@ TEST_GROUP(tiny_gea3_interface)
     address = 0xAD,
 
     receive_buffer_size = 9,
-    send_queue_size = 20
+    send_queue_size = 20,
+
+    receive_pool_block_count = 2,
+    receive_pool_max_payload_length = receive_buffer_size - tiny_gea_packet_overhead
   };
 
   tiny_gea3_interface_t self;
@@ -30,6 +33,12 @@ TEST_GROUP(tiny_gea3_interface)
   tiny_event_subscription_t receive_subscription;
   uint8_t receive_buffer[receive_buffer_size];
   uint8_t send_queue[send_queue_size];
+  tiny_gea_packet_pool_t receive_pool;
+  uint8_t receive_pool_blocks[tiny_gea_packet_pool_storage_size(receive_pool_max_payload_length, receive_pool_block_count)];
+  tiny_gea_packet_t* receive_pool_free_list[receive_pool_block_count];
+  tiny_event_subscription_t retain_subscription;
+  const tiny_gea_packet_t* retained_packets[3];
+  uint8_t retained_packet_count;
 
   void setup()
   {
@@ -120,6 +129,69 @@ TEST_GROUP(tiny_gea3_interface)
     }
   }
 
+  static void retain_packet(void* context, const void* _args)
+  {
+    reinterpret(test, context, TEST_GROUP_CppUTestGrouptiny_gea3_interface*);
+    reinterpret(args, _args, const tiny_gea_interface_on_receive_args_t*);
+
+    if(tiny_gea3_interface_retain(&test->self, args->packet)) {
+      test->retained_packets[test->retained_packet_count++] = args->packet;
+    }
+  }
+
+  void given_that_a_receive_pool_is_used_and_received_packets_are_retained()
+  {
+    tiny_gea_packet_pool_init(
+      &receive_pool,
+      receive_pool_blocks,
+      receive_pool_max_payload_length,
+      receive_pool_block_count,
+      receive_pool_free_list);
+    tiny_gea3_interface_use_receive_pool(&self, &receive_pool);
+
+    retained_packet_count = 0;
+    tiny_event_subscription_init(&retain_subscription, this, retain_packet);
+    tiny_event_subscribe(tiny_gea_interface_on_receive(&self.interface), &retain_subscription);
+  }
+
+  void when_retained_packet_is_released(uint8_t index)
+  {
+    tiny_gea3_interface_release(&self, retained_packets[index]);
+  }
+
+  void retained_packet_should_be(uint8_t index, const tiny_gea_packet_t* packet)
+  {
+    CHECK_EQUAL(packet->source, retained_packets[index]->source);
+    CHECK_EQUAL(packet->destination, retained_packets[index]->destination);
+    CHECK_EQUAL(packet->payload_length, retained_packets[index]->payload_length);
+    MEMCMP_EQUAL(packet->payload, retained_packets[index]->payload, packet->payload_length);
+  }
+
+  void after_a_packet_with_no_payload_is_received()
+  {
+    after_bytes_are_received_via_uart(
+      tiny_gea_stx,
+      address, // dst
+      0x07, // len
+      0x45, // src
+      0x08, // crc
+      0x8F,
+      tiny_gea_etx);
+  }
+
+  void after_a_packet_with_a_payload_is_received()
+  {
+    after_bytes_are_received_via_uart(
+      tiny_gea_stx,
+      address, // dst
+      0x08, // len
+      0x45, // src
+      0xBF, // payload
+      0x74, // crc
+      0x0D,
+      tiny_gea_etx);
+  }
+
   void packet_should_be_received(const tiny_gea_packet_t* packet)
   {
     mock()
@@ -491,6 +563,45 @@ TEST(tiny_gea3_interface, should_receive_a_packet_with_a_payload)
   after_the_interface_is_run();
 }
 
+TEST(tiny_gea3_interface, should_receive_bytes_directly_instead_of_through_the_uart_when_direct_byte_receive_is_used)
+{
+  tiny_gea3_interface_use_direct_byte_receive(&self);
+
+  nothing_should_happen();
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0x74, // crc
+    0x0D,
+    tiny_gea_etx);
+  after_the_interface_is_run();
+
+  const uint8_t bytes[] = {
+    tiny_gea_stx,
+    address, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0x74, // crc
+    0x0D,
+    tiny_gea_etx
+  };
+
+  for(uint8_t i = 0; i < sizeof(bytes); i++) {
+    tiny_gea3_interface_byte_received(&self, bytes[i]);
+  }
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 1);
+  packet->destination = address;
+  packet->source = 0x45;
+  packet->payload[0] = 0xBF;
+  packet_should_be_received(packet);
+  after_the_interface_is_run();
+}
+
 TEST(tiny_gea3_interface, should_receive_a_packet_with_maximum_payload)
 {
   after_bytes_are_received_via_uart(
@@ -625,6 +736,65 @@ TEST(tiny_gea3_interface, should_receive_packets_with_any_address_when_ignoring_
   after_the_interface_is_run();
 }
 
+TEST(tiny_gea3_interface, should_receive_packets_for_addresses_in_the_address_filter)
+{
+  static uint8_t address_filter[32];
+  address_filter[(address + 1) / 8] |= 1 << ((address + 1) % 8);
+  tiny_gea3_interface_set_address_filter(&self, address_filter);
+
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address + 1, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0xEF, // crc
+    0xD1,
+    tiny_gea_etx);
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 1);
+  packet->destination = address + 1;
+  packet->source = 0x45;
+  packet->payload[0] = 0xBF;
+  packet_should_be_received(packet);
+  after_the_interface_is_run();
+}
+
+TEST(tiny_gea3_interface, should_drop_packets_for_addresses_not_in_the_address_filter_and_still_receive_the_next_packet)
+{
+  static uint8_t address_filter[32];
+  address_filter[(address + 2) / 8] |= 1 << ((address + 2) % 8);
+  tiny_gea3_interface_set_address_filter(&self, address_filter);
+
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address + 1, // dst
+    0x08, // len
+    0x45, // src
+    0xBF, // payload
+    0xEF, // crc
+    0xD1,
+    tiny_gea_etx);
+
+  nothing_should_happen();
+  after_the_interface_is_run();
+
+  after_bytes_are_received_via_uart(
+    tiny_gea_stx,
+    address, // dst
+    0x07, // len
+    0x45, // src
+    0x08, // crc
+    0x8F,
+    tiny_gea_etx);
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = address;
+  packet->source = 0x45;
+  packet_should_be_received(packet);
+  after_the_interface_is_run();
+}
+
 TEST(tiny_gea3_interface, should_receive_multiple_packets)
 {
   {
@@ -793,3 +963,187 @@ TEST(tiny_gea3_interface, should_not_publish_received_packets_prior_to_receiving
   packet_should_be_received(packet);
   after_the_interface_is_run();
 }
+
+TEST(tiny_gea3_interface, should_not_use_a_receive_pool_that_has_no_free_block)
+{
+  tiny_gea_packet_pool_init(
+    &receive_pool,
+    receive_pool_blocks,
+    receive_pool_max_payload_length,
+    0,
+    receive_pool_free_list);
+  tiny_gea3_interface_use_receive_pool(&self, &receive_pool);
+
+  POINTERS_EQUAL(NULL, self.receive_pool);
+  POINTERS_EQUAL(receive_buffer, self.receive_buffer);
+}
+
+TEST(tiny_gea3_interface, should_keep_retained_packets_intact_while_receiving_more_packets)
+{
+  given_that_a_receive_pool_is_used_and_received_packets_are_retained();
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet1, 0);
+  packet1->destination = address;
+  packet1->source = 0x45;
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet2, 1);
+  packet2->destination = address;
+  packet2->source = 0x45;
+  packet2->payload[0] = 0xBF;
+
+  after_a_packet_with_no_payload_is_received();
+  packet_should_be_received(packet1);
+  after_the_interface_is_run();
+
+  after_a_packet_with_a_payload_is_received();
+  packet_should_be_received(packet2);
+  after_the_interface_is_run();
+
+  retained_packet_should_be(0, packet1);
+  retained_packet_should_be(1, packet2);
+}
+
+TEST(tiny_gea3_interface, should_drop_packets_while_every_receive_buffer_is_retained_and_resume_after_one_is_released)
+{
+  given_that_a_receive_pool_is_used_and_received_packets_are_retained();
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet1, 0);
+  packet1->destination = address;
+  packet1->source = 0x45;
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet2, 1);
+  packet2->destination = address;
+  packet2->source = 0x45;
+  packet2->payload[0] = 0xBF;
+
+  after_a_packet_with_no_payload_is_received();
+  packet_should_be_received(packet1);
+  after_the_interface_is_run();
+
+  after_a_packet_with_a_payload_is_received();
+  packet_should_be_received(packet2);
+  after_the_interface_is_run();
+
+  after_a_packet_with_no_payload_is_received();
+  nothing_should_happen();
+  after_the_interface_is_run();
+
+  retained_packet_should_be(1, packet2);
+
+  when_retained_packet_is_released(0);
+
+  after_a_packet_with_no_payload_is_received();
+  packet_should_be_received(packet1);
+  after_the_interface_is_run();
+
+  retained_packet_should_be(1, packet2);
+  retained_packet_should_be(2, packet1);
+}
+
+TEST(tiny_gea3_interface, should_return_released_packets_to_the_receive_pool_once)
+{
+  given_that_a_receive_pool_is_used_and_received_packets_are_retained();
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet, 0);
+  packet->destination = address;
+  packet->source = 0x45;
+
+  after_a_packet_with_no_payload_is_received();
+  packet_should_be_received(packet);
+  after_the_interface_is_run();
+
+  CHECK_EQUAL(0, tiny_gea_packet_pool_available(&receive_pool));
+
+  when_retained_packet_is_released(0);
+  CHECK_EQUAL(1, tiny_gea_packet_pool_available(&receive_pool));
+
+  when_retained_packet_is_released(0);
+  CHECK_EQUAL(1, tiny_gea_packet_pool_available(&receive_pool));
+}
+
+TEST(tiny_gea3_interface, should_resume_receiving_into_the_last_retained_buffer_after_it_is_released)
+{
+  given_that_a_receive_pool_is_used_and_received_packets_are_retained();
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet1, 0);
+  packet1->destination = address;
+  packet1->source = 0x45;
+
+  tiny_gea_STATIC_ALLOC_PACKET(packet2, 1);
+  packet2->destination = address;
+  packet2->source = 0x45;
+  packet2->payload[0] = 0xBF;
+
+  after_a_packet_with_no_payload_is_received();
+  packet_should_be_received(packet1);
+  after_the_interface_is_run();
+
+  after_a_packet_with_a_payload_is_received();
+  packet_should_be_received(packet2);
+  after_the_interface_is_run();
+
+  when_retained_packet_is_released(1);
+
+  after_a_packet_with_no_payload_is_received();
+  packet_should_be_received(packet1);
+  after_the_interface_is_run();
+
+  retained_packet_should_be(0, packet1);
+  retained_packet_should_be(2, packet1);
+  POINTERS_EQUAL(retained_packets[1], retained_packets[2]);
+  CHECK_EQUAL(0, tiny_gea_packet_pool_available(&receive_pool));
+}
+
+TEST(tiny_gea3_interface, should_send_priority_packets_before_queued_packets)
+{
+  static uint8_t priority_send_queue[10];
+  static uint8_t priority_commands[32];
+  priority_commands[0xE7 / 8] = 1 << (0xE7 % 8);
+  tiny_gea3_interface_use_priority_send_queue(&self, priority_send_queue, sizeof(priority_send_queue), priority_commands);
+
+  given_that_automatic_send_complete_is(false);
+
+  should_send_bytes_via_uart(tiny_gea_stx);
+
+  tiny_gea_STATIC_ALLOC_PACKET(bulk_packet, 1);
+  bulk_packet->destination = 0x45;
+  bulk_packet->payload[0] = 0xD5;
+  when_packet_is_sent(bulk_packet);
+  when_packet_is_sent(bulk_packet);
+
+  tiny_gea_STATIC_ALLOC_PACKET(priority_packet, 1);
+  priority_packet->destination = 0x45;
+  priority_packet->payload[0] = 0xE7;
+  when_packet_is_sent(priority_packet);
+
+  given_that_automatic_send_complete_is(true);
+
+  should_send_bytes_via_uart(
+    0x45, // dst
+    0x08, // len
+    address, // src
+    0xD5, // payload
+    0x21, // crc
+    0xD3,
+    tiny_gea_etx,
+    tiny_gea_stx,
+    0x45, // dst
+    0x08, // len
+    address, // src
+    0xE7, // payload
+    0x37, // crc
+    0xC2,
+    tiny_gea_etx,
+    tiny_gea_stx,
+    0x45, // dst
+    0x08, // len
+    address, // src
+    0xD5, // payload
+    0x21, // crc
+    0xD3,
+    tiny_gea_etx);
+
+  after_send_completes();
+  after_the_interface_is_run();
+  after_the_interface_is_run();
+}
@@ -0,0 +1,174 @@
+/*!
+ * @file
+ * @brief
+ */
+
+extern "C" {
+#include "tiny_gea_command_demux.h"
+#include "tiny_utils.h"
+}
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+#include "double/tiny_gea_interface_double.hpp"
+
+enum {
+  endpoint_address = 0xA5
+};
+
+#define command(_x) _x
+#define handler(_x) _x
+
+TEST_GROUP(tiny_gea_command_demux)
+{
+  tiny_gea_command_demux_t self;
+  tiny_gea_interface_double_t gea_interface;
+  tiny_gea_command_demux_handler_t handlers[3];
+  uint8_t handler_numbers[3];
+
+  static void packet_received(void* context, const tiny_gea_packet_t* packet)
+  {
+    mock()
+      .actualCall("packet_received")
+      .withParameter("handler", *(const uint8_t*)context)
+      .withParameter("command", packet->payload[0]);
+  }
+
+  static void remove_self(void* context, const tiny_gea_packet_t* packet)
+  {
+    reinterpret(self, context, tiny_gea_command_demux_t*);
+    tiny_gea_command_demux_remove_handler(self, self->handlers[packet->payload[0]]);
+  }
+
+  static void remove_the_next_handler(void* context, const tiny_gea_packet_t* packet)
+  {
+    reinterpret(self, context, tiny_gea_command_demux_t*);
+    tiny_gea_command_demux_remove_handler(self, self->handlers[packet->payload[0]]->next);
+  }
+
+  void setup()
+  {
+    tiny_gea_interface_double_init(&gea_interface, endpoint_address);
+    tiny_gea_command_demux_init(&self, &gea_interface.interface);
+
+    for(uint8_t i = 0; i < 3; i++) {
+      handler_numbers[i] = i;
+    }
+  }
+
+  void given_that_a_handler_is_registered(uint8_t handler, uint8_t command)
+  {
+    tiny_gea_command_demux_add_handler(&self, &handlers[handler], command, &handler_numbers[handler], packet_received);
+  }
+
+  void after_the_handler_is_removed(uint8_t handler)
+  {
+    tiny_gea_command_demux_remove_handler(&self, &handlers[handler]);
+  }
+
+  void after_a_packet_is_received(uint8_t command)
+  {
+    tiny_gea_STACK_ALLOC_PACKET(packet, 1);
+    packet->source = 0x54;
+    packet->destination = endpoint_address;
+    packet->payload[0] = command;
+
+    tiny_gea_interface_double_trigger_receive(&gea_interface, packet);
+  }
+
+  void after_an_empty_packet_is_received()
+  {
+    tiny_gea_STACK_ALLOC_PACKET(packet, 0);
+    packet->source = 0x54;
+    packet->destination = endpoint_address;
+
+    tiny_gea_interface_double_trigger_receive(&gea_interface, packet);
+  }
+
+  void the_packet_should_be_handled_by(uint8_t handler, uint8_t command)
+  {
+    mock()
+      .expectOneCall("packet_received")
+      .withParameter("handler", handler)
+      .withParameter("command", command);
+  }
+
+  void nothing_should_happen()
+  {
+  }
+};
+
+TEST(tiny_gea_command_demux, should_deliver_packets_only_to_handlers_for_their_command)
+{
+  given_that_a_handler_is_registered(handler(0), command(0xA1));
+  given_that_a_handler_is_registered(handler(1), command(0xF0));
+
+  the_packet_should_be_handled_by(handler(0), command(0xA1));
+  after_a_packet_is_received(command(0xA1));
+
+  the_packet_should_be_handled_by(handler(1), command(0xF0));
+  after_a_packet_is_received(command(0xF0));
+}
+
+TEST(tiny_gea_command_demux, should_discard_packets_with_no_handlers)
+{
+  given_that_a_handler_is_registered(handler(0), command(0xA1));
+
+  nothing_should_happen();
+  after_a_packet_is_received(command(0xA3));
+  after_an_empty_packet_is_received();
+}
+
+TEST(tiny_gea_command_demux, should_deliver_packets_to_every_handler_for_a_command_in_the_order_they_were_added)
+{
+  mock().strictOrder();
+
+  given_that_a_handler_is_registered(handler(0), command(0xA1));
+  given_that_a_handler_is_registered(handler(1), command(0xA1));
+  given_that_a_handler_is_registered(handler(2), command(0xA1));
+
+  the_packet_should_be_handled_by(handler(0), command(0xA1));
+  the_packet_should_be_handled_by(handler(1), command(0xA1));
+  the_packet_should_be_handled_by(handler(2), command(0xA1));
+  after_a_packet_is_received(command(0xA1));
+}
+
+TEST(tiny_gea_command_demux, should_stop_delivering_packets_to_a_removed_handler)
+{
+  given_that_a_handler_is_registered(handler(0), command(0xA1));
+  given_that_a_handler_is_registered(handler(1), command(0xA1));
+  given_that_a_handler_is_registered(handler(2), command(0xA1));
+  after_the_handler_is_removed(handler(1));
+
+  the_packet_should_be_handled_by(handler(0), command(0xA1));
+  the_packet_should_be_handled_by(handler(2), command(0xA1));
+  after_a_packet_is_received(command(0xA1));
+
+  after_the_handler_is_removed(handler(0));
+  after_the_handler_is_removed(handler(2));
+
+  nothing_should_happen();
+  after_a_packet_is_received(command(0xA1));
+}
+
+TEST(tiny_gea_command_demux, should_allow_a_handler_to_remove_itself_while_handling_a_packet)
+{
+  tiny_gea_command_demux_add_handler(&self, &handlers[0], command(0xA1), &self, remove_self);
+  given_that_a_handler_is_registered(handler(1), command(0xA1));
+
+  the_packet_should_be_handled_by(handler(1), command(0xA1));
+  after_a_packet_is_received(command(0xA1));
+
+  the_packet_should_be_handled_by(handler(1), command(0xA1));
+  after_a_packet_is_received(command(0xA1));
+}
+
+TEST(tiny_gea_command_demux, should_allow_a_handler_to_remove_the_next_handler_while_handling_a_packet)
+{
+  tiny_gea_command_demux_add_handler(&self, &handlers[0], command(0xA1), &self, remove_the_next_handler);
+  given_that_a_handler_is_registered(handler(1), command(0xA1));
+  given_that_a_handler_is_registered(handler(2), command(0xA1));
+
+  the_packet_should_be_handled_by(handler(2), command(0xA1));
+  after_a_packet_is_received(command(0xA1));
+}
@@ -0,0 +1,115 @@
+/*!
+ * @file
+ * @brief
+ */
+
+extern "C" {
+#include "tiny_gea_erd_view.h"
+}
+
+#include "CppUTest/TestHarness.h"
+
+TEST_GROUP(tiny_gea_erd_view)
+{
+  tiny_gea_erd_view_t self;
+  tiny_gea_erd_view_entry_t entry;
+
+  void given_a_view_over(const uint8_t* entries, uint8_t entries_size, uint8_t erd_count)
+  {
+    tiny_gea_erd_view_init(&self, entries, entries_size, erd_count);
+  }
+
+  void the_next_entry_should_be(tiny_erd_t erd, const uint8_t* data, uint8_t data_size)
+  {
+    CHECK_TRUE(tiny_gea_erd_view_next(&self, &entry));
+    CHECK_EQUAL(erd, entry.erd);
+    CHECK_EQUAL(data_size, entry.data_size);
+    POINTERS_EQUAL(data, entry.data);
+  }
+
+  void there_should_be_no_more_entries()
+  {
+    CHECK_FALSE(tiny_gea_erd_view_next(&self, &entry));
+  }
+
+  void the_view_should_be_complete()
+  {
+    CHECK_TRUE(tiny_gea_erd_view_complete(&self));
+  }
+
+  void the_view_should_not_be_complete()
+  {
+    CHECK_FALSE(tiny_gea_erd_view_complete(&self));
+  }
+};
+
+TEST(tiny_gea_erd_view, should_visit_each_entry_without_copying)
+{
+  static const uint8_t entries[] = { 0x12, 0x34, 1, 0xAB, 0x56, 0x78, 2, 0xCD, 0xEF };
+  given_a_view_over(entries, sizeof(entries), 2);
+
+  the_next_entry_should_be(0x1234, &entries[3], 1);
+  the_next_entry_should_be(0x5678, &entries[7], 2);
+  there_should_be_no_more_entries();
+  the_view_should_be_complete();
+}
+
+TEST(tiny_gea_erd_view, should_allow_entries_with_no_data)
+{
+  static const uint8_t entries[] = { 0x12, 0x34, 0 };
+  given_a_view_over(entries, sizeof(entries), 1);
+
+  the_next_entry_should_be(0x1234, &entries[3], 0);
+  the_view_should_be_complete();
+}
+
+TEST(tiny_gea_erd_view, should_stop_at_an_entry_whose_data_runs_past_the_end)
+{
+  static const uint8_t entries[] = { 0x12, 0x34, 1, 0xAB, 0x56, 0x78, 2, 0xCD };
+  given_a_view_over(entries, sizeof(entries), 2);
+
+  the_next_entry_should_be(0x1234, &entries[3], 1);
+  there_should_be_no_more_entries();
+  the_view_should_not_be_complete();
+}
+
+TEST(tiny_gea_erd_view, should_stop_at_an_entry_whose_header_runs_past_the_end)
+{
+  static const uint8_t entries[] = { 0x12, 0x34, 1, 0xAB, 0x56, 0x78 };
+  given_a_view_over(entries, sizeof(entries), 2);
+
+  the_next_entry_should_be(0x1234, &entries[3], 1);
+  there_should_be_no_more_entries();
+  the_view_should_not_be_complete();
+}
+
+TEST(tiny_gea_erd_view, should_not_be_complete_when_there_are_extra_bytes_after_the_last_entry)
+{
+  static const uint8_t entries[] = { 0x12, 0x34, 1, 0xAB, 0x00 };
+  given_a_view_over(entries, sizeof(entries), 1);
+
+  the_next_entry_should_be(0x1234, &entries[3], 1);
+  there_should_be_no_more_entries();
+  the_view_should_not_be_complete();
+}
+
+TEST(tiny_gea_erd_view, should_view_entries_in_a_packet_payload)
+{
+  tiny_gea_STACK_ALLOC_PACKET(packet, 6);
+  packet->payload[0] = 0xF0;
+  packet->payload[1] = 1;
+  packet->payload[2] = 0x12;
+  packet->payload[3] = 0x34;
+  packet->payload[4] = 1;
+  packet->payload[5] = 0xAB;
+
+  CHECK_TRUE(tiny_gea_erd_view_init_from_packet(&self, packet, 2, 1));
+  the_next_entry_should_be(0x1234, &packet->payload[5], 1);
+  the_view_should_be_complete();
+}
+
+TEST(tiny_gea_erd_view, should_reject_an_offset_past_the_end_of_the_payload)
+{
+  tiny_gea_STACK_ALLOC_PACKET(packet, 2);
+  CHECK_FALSE(tiny_gea_erd_view_init_from_packet(&self, packet, 3, 1));
+}
@@ -0,0 +1,168 @@
+/*!
+ * @file
+ * @brief
+ */
+
+extern "C" {
+#include "tiny_gea_packet_pool.h"
+}
+
+#include "CppUTest/TestHarness.h"
+
+enum {
+  max_payload_length = 5,
+  block_count = 3
+};
+
+TEST_GROUP(tiny_gea_packet_pool)
+{
+  tiny_gea_packet_pool_t self;
+  uint8_t blocks[tiny_gea_packet_pool_storage_size(max_payload_length, block_count)];
+  tiny_gea_packet_t* free_list[block_count];
+
+  void setup()
+  {
+    tiny_gea_packet_pool_init(&self, blocks, max_payload_length, block_count, free_list);
+  }
+};
+
+TEST(tiny_gea_packet_pool, should_allocate_distinct_blocks_within_the_storage)
+{
+  tiny_gea_packet_t* packets[block_count];
+
+  for(uint8_t i = 0; i < block_count; i++) {
+    packets[i] = tiny_gea_packet_pool_allocate(&self);
+    CHECK((uint8_t*)packets[i] >= blocks);
+    CHECK((uint8_t*)packets[i] + max_payload_length + tiny_gea_packet_overhead <= blocks + sizeof(blocks));
+    CHECK_EQUAL(max_payload_length, packets[i]->payload_length);
+  }
+
+  CHECK(packets[0] != packets[1]);
+  CHECK(packets[1] != packets[2]);
+  CHECK(packets[0] != packets[2]);
+}
+
+TEST(tiny_gea_packet_pool, should_fail_to_allocate_when_every_block_is_in_use)
+{
+  for(uint8_t i = 0; i < block_count; i++) {
+    CHECK(tiny_gea_packet_pool_allocate(&self) != NULL);
+  }
+
+  CHECK_EQUAL(0, tiny_gea_packet_pool_available(&self));
+  POINTERS_EQUAL(NULL, tiny_gea_packet_pool_allocate(&self));
+}
+
+TEST(tiny_gea_packet_pool, should_reuse_freed_blocks)
+{
+  tiny_gea_packet_t* first = tiny_gea_packet_pool_allocate(&self);
+  tiny_gea_packet_pool_allocate(&self);
+  tiny_gea_packet_pool_allocate(&self);
+
+  tiny_gea_packet_pool_free(&self, first);
+
+  CHECK_EQUAL(1, tiny_gea_packet_pool_available(&self));
+  POINTERS_EQUAL(first, tiny_gea_packet_pool_allocate(&self));
+}
+
+TEST(tiny_gea_packet_pool, should_ignore_packets_that_were_not_allocated_from_the_pool)
+{
+  tiny_gea_STACK_ALLOC_PACKET(packet, 1);
+
+  tiny_gea_packet_pool_allocate(&self);
+  tiny_gea_packet_pool_free(&self, packet);
+  tiny_gea_packet_pool_free(&self, (tiny_gea_packet_t*)&blocks[1]);
+
+  CHECK_EQUAL(block_count - 1, tiny_gea_packet_pool_available(&self));
+}
+
+TEST(tiny_gea_packet_pool, should_ignore_a_packet_that_is_freed_twice)
+{
+  tiny_gea_packet_t* first = tiny_gea_packet_pool_allocate(&self);
+  tiny_gea_packet_t* second = tiny_gea_packet_pool_allocate(&self);
+  tiny_gea_packet_pool_allocate(&self);
+
+  tiny_gea_packet_pool_free(&self, first);
+  tiny_gea_packet_pool_free(&self, first);
+
+  CHECK_EQUAL(1, tiny_gea_packet_pool_available(&self));
+  POINTERS_EQUAL(first, tiny_gea_packet_pool_allocate(&self));
+  POINTERS_EQUAL(NULL, tiny_gea_packet_pool_allocate(&self));
+
+  tiny_gea_packet_pool_free(&self, second);
+  tiny_gea_packet_pool_free(&self, first);
+  tiny_gea_packet_pool_free(&self, second);
+
+  CHECK_EQUAL(2, tiny_gea_packet_pool_available(&self));
+}
+
+TEST_GROUP(tiny_gea_packet_queue)
+{
+  enum {
+    entry_count = 3
+  };
+
+  tiny_gea_packet_queue_t self;
+  tiny_gea_packet_t* entries[entry_count];
+  uint8_t storage[4][tiny_gea_packet_overhead + 1];
+
+  void setup()
+  {
+    tiny_gea_packet_queue_init(&self, entries, entry_count);
+  }
+
+  tiny_gea_packet_t* packet(uint8_t index)
+  {
+    return (tiny_gea_packet_t*)storage[index];
+  }
+};
+
+TEST(tiny_gea_packet_queue, should_dequeue_packets_in_the_order_they_were_enqueued)
+{
+  tiny_gea_packet_queue_enqueue(&self, packet(0));
+  tiny_gea_packet_queue_enqueue(&self, packet(1));
+
+  POINTERS_EQUAL(packet(0), tiny_gea_packet_queue_dequeue(&self));
+  POINTERS_EQUAL(packet(1), tiny_gea_packet_queue_dequeue(&self));
+  POINTERS_EQUAL(NULL, tiny_gea_packet_queue_dequeue(&self));
+}
+
+TEST(tiny_gea_packet_queue, should_not_enqueue_when_full)
+{
+  CHECK_TRUE(tiny_gea_packet_queue_enqueue(&self, packet(0)));
+  CHECK_TRUE(tiny_gea_packet_queue_enqueue(&self, packet(1)));
+  CHECK_TRUE(tiny_gea_packet_queue_enqueue(&self, packet(2)));
+  CHECK_FALSE(tiny_gea_packet_queue_enqueue(&self, packet(3)));
+
+  CHECK_EQUAL(entry_count, tiny_gea_packet_queue_count(&self));
+}
+
+TEST(tiny_gea_packet_queue, should_hold_at_most_127_entries)
+{
+  tiny_gea_packet_t* large_entries[200];
+  tiny_gea_packet_queue_init(&self, large_entries, 200);
+
+  for(uint8_t i = 0; i < 127; i++) {
+    CHECK_TRUE(tiny_gea_packet_queue_enqueue(&self, packet(0)));
+  }
+  CHECK_FALSE(tiny_gea_packet_queue_enqueue(&self, packet(0)));
+
+  CHECK_EQUAL(127, tiny_gea_packet_queue_count(&self));
+}
+
+TEST(tiny_gea_packet_queue, should_peek_any_queued_packet_after_wrapping_around)
+{
+  for(uint8_t i = 0; i < 5; i++) {
+    tiny_gea_packet_queue_enqueue(&self, packet(0));
+    tiny_gea_packet_queue_dequeue(&self);
+  }
+
+  tiny_gea_packet_queue_enqueue(&self, packet(1));
+  tiny_gea_packet_queue_enqueue(&self, packet(2));
+  tiny_gea_packet_queue_enqueue(&self, packet(3));
+
+  POINTERS_EQUAL(packet(1), tiny_gea_packet_queue_peek(&self, 0));
+  POINTERS_EQUAL(packet(2), tiny_gea_packet_queue_peek(&self, 1));
+  POINTERS_EQUAL(packet(3), tiny_gea_packet_queue_peek(&self, 2));
+  POINTERS_EQUAL(NULL, tiny_gea_packet_queue_peek(&self, 3));
+  CHECK_EQUAL(3, tiny_gea_packet_queue_count(&self));
+}